@@ -3,40 +3,168 @@
 
 #include "../random/mersenne.hpp"
 #include "../random/random.hpp"
+#include "../utility/statistics.hpp"
+#include "boltzmann_table.hpp"
+#include "proposals.hpp"
 
+#include <cmath>
+#include <cstddef>
+#include <numeric>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace qss {
 inline namespace algorithms {
 namespace metropolis {
+/*
+ * порядок обхода узлов за шаг Монте-Карло:
+ * random -- каждый раз случайный узел (с повторами),
+ * sequential -- все узлы по порядку хранилища, подряд по памяти,
+ * permutation -- все узлы по одному разу в случайном порядке, новая перестановка на каждый шаг
+ **/
+enum class sweep_order_t {
+    random,
+    sequential,
+    permutation,
+};
+
 /*
  * Свободная процедура для прохождения одного шага Монте-Карло.
  * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+ * если delta_energy_f принимает номер узла (lattice_t::idx_t) вместо координат,
+ * то узлы выбираются по номеру в хранилище, без перехода к координатам
+ * (используется вместе с таблицей соседей, см. lattices/neighbours_table.hpp)
+ * при QSS_STATISTICS попытки, принятия и время по фазам добавляются в qss::get_thread_statistics()
+ * {sweep_order} -- порядок обхода узлов (см. sweep_order_t),
+ * {proposal} -- способ предложить новое значение узла (см. proposals.hpp),
+ * после шага ему передаётся число принятых и предложенных изменений.
+ * все случайные числа шага берутся из {rand}, поэтому с генератором, принадлежащим системе
+ * или реплике, шаг воспроизводим независимо от того, в каком потоке он выполняется
  **/
 template<
     typename lattice_t,
     typename delta_energy_f_t,
-    Random random_t = qss::random::mersenne::random_t<>> // TODO: ограничить typename и auto
+    typename proposal_t,
+    Random random_t> // TODO: ограничить typename и auto
 std::pair<typename lattice_t::value_t::magn_t, double>
-make_step(lattice_t& lattice, delta_energy_f_t delta_energy_f, double temperature)
+make_step(
+    lattice_t& lattice,
+    delta_energy_f_t delta_energy_f,
+    double temperature,
+    const sweep_order_t sweep_order,
+    proposal_t& proposal,
+    random_t& rand)
 {
-    static random_t rand{qss::random::get_seed()};
+    using value_t = typename lattice_t::value_t;
+    using idx_t = typename lattice_t::idx_t;
+    constexpr bool by_idx
+        = std::is_invocable_r_v<double, delta_energy_f_t&, const lattice_t&, idx_t, const value_t&>;
+
+    static thread_local boltzmann_table_t<value_t> boltzmann{};
+    static thread_local std::vector<idx_t> permutation{};
+    boltzmann.update(temperature);
     double delta_energy = 0.0;
-    typename lattice_t::value_t::magn_t delta_magn{};
-    for (auto _ = 0llu; _ < lattice.get_amount_of_nodes(); ++_) {
-        const auto old_spin_coords = lattice.template choose_random_node<random_t>();
-        const auto spin_new = lattice_t::value_t::template generate<random_t>();
-
-        const double dE = delta_energy_f(lattice, old_spin_coords, spin_new); // E_old - E_new
-        const auto old_spin = lattice.get(old_spin_coords);
-        if (dE < 0.0 || rand() < std::exp(-dE / temperature)) {
-            lattice.set(spin_new, old_spin_coords);
-            delta_energy += dE;
-            delta_magn += spin_new - old_spin;
+    typename value_t::magn_t delta_magn{};
+    std::size_t accepted = 0;
+    const auto amount = lattice.get_amount_of_nodes();
+    if (sweep_order == sweep_order_t::permutation) {
+        // Фишер -- Йетс
+        permutation.resize(amount);
+        std::iota(permutation.begin(), permutation.end(), idx_t{0});
+        for (auto i = amount; i > 1; --i) {
+            const auto j = static_cast<idx_t>(rand(0, static_cast<int>(i)));
+            std::swap(permutation[i - 1], permutation[j]);
         }
     }
+    auto choose_idx = [&](const idx_t trial) -> idx_t {
+        switch (sweep_order) {
+        case sweep_order_t::sequential:
+            return trial;
+        case sweep_order_t::permutation:
+            return permutation[trial];
+        default:
+            return static_cast<idx_t>(rand(0, static_cast<int>(amount)));
+        }
+    };
+    QSS_STATISTICS_ONLY(auto& statistics = qss::get_thread_statistics(); qss::stopwatch_t stopwatch{};)
+    for (idx_t trial = 0; trial < amount; ++trial) {
+        QSS_STATISTICS_ONLY(++statistics.proposals;)
+        if constexpr (by_idx) {
+            const auto idx = choose_idx(trial);
+            const auto old_spin = lattice.get_by_idx(idx);
+            const auto spin_new = proposal(old_spin, rand);
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.random_ns);)
+
+            const double dE = delta_energy_f(lattice, idx, spin_new); // E_old - E_new
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.neighbours_ns);)
+            if (dE < 0.0 || rand() < boltzmann(dE)) {
+                lattice.set_by_idx(spin_new, idx);
+                delta_energy += dE;
+                delta_magn += spin_new - old_spin;
+                ++accepted;
+                QSS_STATISTICS_ONLY(++statistics.acceptances;)
+            } else {
+                QSS_STATISTICS_ONLY(statistics.reject(qss::rejection_t::boltzmann);)
+            }
+        } else {
+            const auto old_spin_coords = sweep_order == sweep_order_t::random
+                ? lattice.choose_random_node(rand)
+                : lattice.get_coords(choose_idx(trial));
+            const auto old_spin = lattice.get_unchecked(old_spin_coords);
+            const auto spin_new = proposal(old_spin, rand);
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.random_ns);)
+
+            const double dE = delta_energy_f(lattice, old_spin_coords, spin_new); // E_old - E_new
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.neighbours_ns);)
+            if (dE < 0.0 || rand() < boltzmann(dE)) {
+                lattice.set_unchecked(spin_new, old_spin_coords);
+                delta_energy += dE;
+                delta_magn += spin_new - old_spin;
+                ++accepted;
+                QSS_STATISTICS_ONLY(++statistics.acceptances;)
+            } else {
+                QSS_STATISTICS_ONLY(statistics.reject(qss::rejection_t::boltzmann);)
+            }
+        }
+        QSS_STATISTICS_ONLY(stopwatch.lap(statistics.acceptance_ns);)
+    }
+    proposal.adapt(accepted, static_cast<std::size_t>(amount));
     return std::pair{delta_magn, delta_energy};
 }
+// случайные числа -- из генератора потока (свой у каждого потока и набора типов)
+template<
+    typename lattice_t,
+    typename delta_energy_f_t,
+    typename proposal_t,
+    Random random_t = qss::random::mersenne::random_t<>>
+std::pair<typename lattice_t::value_t::magn_t, double>
+make_step(
+    lattice_t& lattice,
+    delta_energy_f_t delta_energy_f,
+    double temperature,
+    const sweep_order_t sweep_order,
+    proposal_t& proposal)
+{
+    static thread_local random_t rand{qss::random::get_seed()};
+    return make_step(lattice, std::move(delta_energy_f), temperature, sweep_order, proposal, rand);
+}
+// новое значение узла берётся из value_t::generate(), независимо от старого
+template<
+    typename lattice_t,
+    typename delta_energy_f_t,
+    Random random_t = qss::random::mersenne::random_t<>>
+std::pair<typename lattice_t::value_t::magn_t, double>
+make_step(
+    lattice_t& lattice,
+    delta_energy_f_t delta_energy_f,
+    double temperature,
+    const sweep_order_t sweep_order = sweep_order_t::random)
+{
+    uniform_proposal_t proposal{};
+    return make_step<lattice_t, delta_energy_f_t, uniform_proposal_t, random_t>(
+        lattice, std::move(delta_energy_f), temperature, sweep_order, proposal);
+}
 } // namespace metropolis
 } // namespace algorithms
 } // namespace qss
@@ -0,0 +1,55 @@
+#ifndef BOLTZMANN_TABLE_HPP_INCLUDED
+#define BOLTZMANN_TABLE_HPP_INCLUDED
+
+#include "../models/spin.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace qss {
+inline namespace algorithms {
+/*
+ * больцмановский множитель exp(-dE / T) для алгоритма Метрополиса.
+ * для моделей с дискретным спектром (energy_spectrum_traits) множители для целых dE
+ * из [0; max_delta_energy] берутся из таблицы, пересчитываемой только при смене температуры,
+ * для нецелых или слишком больших dE, как и для остальных моделей, вызывается std::exp
+ **/
+template<typename spin_t>
+class boltzmann_table_t {
+    static constexpr bool is_discrete = has_discrete_energy_v<spin_t>;
+    static constexpr int max_delta_energy = energy_spectrum_traits<spin_t>::max_delta_energy;
+    std::vector<double> factors = std::vector<double>(is_discrete ? max_delta_energy + 1 : 0, 1.0);
+    // NaN не равен никакой температуре, поэтому первый update всегда заполняет таблицу
+    double temperature = std::numeric_limits<double>::quiet_NaN();
+
+public:
+    void update(const double temperature_) noexcept
+    {
+        if (temperature_ == temperature) {
+            return;
+        }
+        temperature = temperature_;
+        if constexpr (is_discrete) {
+            for (int dE = 0; dE <= max_delta_energy; ++dE) {
+                factors[static_cast<std::size_t>(dE)] = std::exp(-dE / temperature);
+            }
+        }
+    }
+
+    [[nodiscard]] double operator()(const double dE) const noexcept
+    {
+        if constexpr (is_discrete) {
+            const double rounded = std::nearbyint(dE);
+            if (rounded == dE && rounded >= 0.0 && rounded <= max_delta_energy) {
+                return factors[static_cast<std::size_t>(rounded)];
+            }
+        }
+        return std::exp(-dE / temperature);
+    }
+};
+} // namespace algorithms
+} // namespace qss
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef CHECKERBOARD_HPP_INCLUDED
+#define CHECKERBOARD_HPP_INCLUDED
+
+#include "../lattices/2d/square.hpp"
+#include "../lattices/3d/fcc.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/philox.hpp"
+#include "../random/random.hpp"
+#include "../utility/parallel.hpp"
+#include "boltzmann_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qss {
+inline namespace algorithms {
+namespace checkerboard {
+/*
+ * узлы с шагом {stride} из полуинтервала [begin; end) хранилища решётки
+ **/
+struct range_t {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t stride;
+
+    [[nodiscard]] std::size_t get_amount_of_nodes() const noexcept
+    {
+        return end > begin ? (end - begin + stride - 1) / stride : 0;
+    }
+};
+// множество узлов одного цвета: никакие два из них не являются соседями
+using color_class_t = std::vector<range_t>;
+
+/*
+ * шахматная раскраска квадратной решётки: цвет узла (x + y) % 2
+ * при периодических границах корректна только для чётных размеров,
+ * поэтому нечётные размеры не допускаются
+ **/
+template<typename node_t>
+[[nodiscard]] std::vector<color_class_t>
+get_color_classes(const qss::lattices::two_d::square<node_t>& lattice)
+{
+    if (lattice.sizes.x % 2 != 0 || lattice.sizes.y % 2 != 0) {
+        throw std::logic_error(
+            "checkerboard decomposition requires even sizes : " + std::to_string(lattice.sizes.x)
+            + " x " + std::to_string(lattice.sizes.y));
+    }
+    std::vector<color_class_t> result(2);
+    for (std::size_t y = 0; y < lattice.sizes.y; ++y) {
+        const std::size_t row = y * lattice.sizes.x;
+        for (std::size_t color = 0; color < 2; ++color) {
+            result[color].push_back({row + (y + color) % 2, row + lattice.sizes.x, 2});
+        }
+    }
+    return result;
+}
+
+/*
+ * раскраска ГЦК решётки: цвет узла -- номер его простой подрешётки {w}.
+ * соседи узла всегда лежат в других подрешётках (см. get_closest_neighbours),
+ * поэтому раскраска корректна при любых размерах и граничных условиях,
+ * в том числе для плёнок (периодические по XY, резкие по Z).
+ * подрешётки хранятся подряд, так что каждый цвет -- один непрерывный участок хранилища
+ **/
+template<typename node_t>
+[[nodiscard]] std::vector<color_class_t>
+get_color_classes(const qss::lattices::three_d::face_centric_cubic<node_t>& lattice)
+{
+    using coords_t = typename qss::lattices::three_d::face_centric_cubic<node_t>::coords_t;
+    std::vector<color_class_t> result(4);
+    for (std::uint8_t w = 0; w < 4; ++w) {
+        const std::size_t begin = lattice.get_idx(coords_t{w, 0, 0, 0});
+        const std::size_t end = w < 3 ? lattice.get_idx(coords_t{static_cast<std::uint8_t>(w + 1), 0, 0, 0})
+                                      : lattice.get_amount_of_nodes();
+        result[w].push_back({begin, end, 1});
+    }
+    return result;
+}
+
+/*
+ * параллельный проход Метрополиса по цветам:
+ * узлы одного цвета обновляются одновременно несколькими потоками, затем следующий цвет.
+ * потоки создаются один раз вместе с движком (qss::thread_team) и переиспользуются всеми шагами.
+ * случайные числа берутся из счётчиковых потоков (random/philox.hpp), привязанных
+ * к блокам по {stream_block_size} узлов цвета, номеру цвета и номеру шага,
+ * поэтому при одном сиде результат воспроизводим и не зависит от числа потоков.
+ * random_t должен строиться из qss::random::philox::philox4x32.
+ * delta_energy_f(lattice, idx, new_spin) должна только читать решётку
+ **/
+template<Random random_t = qss::random::mersenne::random_t<qss::random::philox::philox4x32>>
+class engine_t {
+    // потоки живут всё время жизни движка, по указателю -- чтобы движок оставался перемещаемым
+    std::unique_ptr<qss::thread_team> team;
+    std::uint64_t seed;
+    std::uint32_t sweep = 0;
+
+public:
+    /*
+     * узлов на один случайный поток и наименьшая доля работы потока:
+     * мелкие блоки делят между потоками даже цвета плёнок в тысячу узлов
+     **/
+    static constexpr std::size_t stream_block_size = 64;
+
+    explicit engine_t(
+        const std::size_t threads_amount_ = qss::get_default_threads_amount(),
+        const std::uint64_t seed_ = qss::random::get_seed())
+        : team{std::make_unique<qss::thread_team>(threads_amount_)}
+        , seed{seed_}
+    {
+    }
+
+    [[nodiscard]] std::size_t get_threads_amount() const noexcept
+    {
+        return team->get_threads_amount();
+    }
+    // номер следующего шага, входит в ключ случайных потоков
+    [[nodiscard]] std::uint32_t get_sweep() const noexcept
+    {
+        return sweep;
+    }
+
+    /*
+     * один шаг Монте-Карло (каждый узел предлагается к изменению один раз)
+     * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+     **/
+    template<typename lattice_t, typename delta_energy_f_t>
+    std::pair<typename lattice_t::value_t::magn_t, double> make_step(
+        lattice_t& lattice,
+        const std::vector<color_class_t>& color_classes,
+        delta_energy_f_t delta_energy_f,
+        double temperature)
+    {
+        using value_t = typename lattice_t::value_t;
+        using magn_t = typename value_t::magn_t;
+        using idx_t = typename lattice_t::idx_t;
+
+        // таблица своя у каждого вызова: движки могут работать одновременно при разных T
+        boltzmann_table_t<value_t> boltzmann{};
+        boltzmann.update(temperature);
+
+        const auto threads_amount = team->get_threads_amount();
+        // изменения копятся по блокам и складываются в порядке блоков, чтобы и сумма не зависела от числа потоков
+        std::vector<std::pair<magn_t, double>> deltas{};
+        std::pair<magn_t, double> result{};
+        const auto colors_amount = static_cast<std::uint32_t>(color_classes.size());
+        for (std::uint32_t color = 0; color < colors_amount; ++color) {
+            const auto& color_class = color_classes[color];
+            std::size_t amount = 0;
+            for (const auto& range : color_class) {
+                amount += range.get_amount_of_nodes();
+            }
+            deltas.assign((amount + stream_block_size - 1) / stream_block_size, {});
+            team->run([&](const std::size_t thread_idx) {
+                random_t rand{};
+                // поток берёт подряд идущие блоки узлов цвета с номерами [first; last)
+                const auto [first, last]
+                    = qss::get_block_chunk(amount, stream_block_size, thread_idx, threads_amount);
+                std::size_t passed = 0;
+                for (const auto& range : color_class) {
+                    const auto range_amount = range.get_amount_of_nodes();
+                    if (passed + range_amount <= first) {
+                        passed += range_amount;
+                        continue;
+                    }
+                    if (passed >= last) {
+                        break;
+                    }
+                    const auto skip = first > passed ? first - passed : 0;
+                    const auto take = std::min(range_amount, last - passed) - skip;
+                    auto idx = static_cast<idx_t>(range.begin + skip * range.stride);
+                    for (std::size_t i = 0; i < take; ++i, idx += range.stride) {
+                        const auto ordinal = passed + skip + i;
+                        if (ordinal % stream_block_size == 0) {
+                            rand = random_t{qss::random::philox::make_stream(
+                                seed, 0, static_cast<std::uint32_t>(ordinal), sweep * colors_amount + color)};
+                        }
+                        const auto spin_new = value_t::generate(rand);
+                        const double dE = delta_energy_f(lattice, idx, spin_new);
+                        if (dE < 0.0 || rand() < boltzmann(dE)) {
+                            const auto old_spin = lattice.get_by_idx(idx);
+                            lattice.set_by_idx(spin_new, idx);
+                            auto& [delta_magn, delta_energy] = deltas[ordinal / stream_block_size];
+                            delta_energy += dE;
+                            delta_magn += spin_new - old_spin;
+                        }
+                    }
+                    passed += range_amount;
+                }
+            });
+            for (const auto& [delta_magn, delta_energy] : deltas) {
+                result.first += delta_magn;
+                result.second += delta_energy;
+            }
+        }
+
+        ++sweep;
+
+        return result;
+    }
+};
+} // namespace checkerboard
+} // namespace algorithms
+} // namespace qss
+
+#endif
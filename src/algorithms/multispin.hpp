@@ -0,0 +1,168 @@
+#ifndef MULTISPIN_HPP_INCLUDED
+#define MULTISPIN_HPP_INCLUDED
+
+#include "../lattices/2d/packed_square.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/random.hpp"
+
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace qss {
+inline namespace algorithms {
+namespace multispin {
+using word_t = qss::lattices::two_d::packed_square::word_t;
+
+/*
+ * вероятность {p}, записанная двоичной дробью: digits[k] -- все единицы, если k+1-й знак равен 1.
+ * случайное слово, каждый бит которого равен 1 с вероятностью {p} независимо от других,
+ * получается сравнением 64 равномерных чисел с {p} разряд за разрядом, начиная со старшего.
+ * {p} приводится к [0; 1]: при p >= 1 все биты единичные, при p <= 0 (и NaN) -- нулевые
+ **/
+class probability_mask_t {
+    static constexpr std::size_t digits_amount = 53;
+    std::array<word_t, digits_amount> digits{};
+    bool is_certain = false; // p >= 1
+
+public:
+    probability_mask_t() noexcept = default;
+    explicit probability_mask_t(double p) noexcept
+    {
+        if (p >= 1.0) {
+            is_certain = true;
+            return;
+        }
+        if (!(p > 0.0)) {
+            return;
+        }
+        for (auto& digit : digits) {
+            p *= 2.0;
+            digit = p >= 1.0 ? ~word_t{0} : word_t{0};
+            p -= std::floor(p);
+        }
+    }
+
+    // нужны только биты {lanes}, остальные в результате нулевые
+    template<typename random_t>
+    [[nodiscard]] word_t generate(random_t& rand, word_t lanes) const noexcept
+    {
+        if (is_certain) {
+            return lanes;
+        }
+        word_t result = 0;
+        for (std::size_t k = 0; k < digits_amount && lanes != 0; ++k) {
+            const word_t bits = rand.get_bits();
+            result |= lanes & digits[k] & ~bits; // разряд числа меньше разряда p
+            lanes &= ~(digits[k] ^ bits);        // разряды совпали -- решается дальше
+        }
+        return result;
+    }
+};
+
+/*
+ * Метрополис с мультиспиновым кодированием для packed_square (J -- обменный интеграл).
+ * за шаг каждое слово обновляется дважды, по узлам каждого из двух цветов шахматной раскраски,
+ * так что все 64 узла слова обновляются одновременно битовыми операциями.
+ * число антипараллельных соседей {a} считается сумматорами по битовым плоскостям,
+ * при a >= 2 переворот принимается всегда, при a = 1 и a = 0 -- с вероятностями
+ * exp(-4J/T) и exp(-8J/T) из заранее подготовленных масок.
+ * безусловное принятие при a >= 2 верно только для ферромагнетика, поэтому J < 0 -- logic_error.
+ * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+ **/
+template<Random random_t = qss::random::mersenne::random_t<std::mt19937_64>>
+std::pair<double, double>
+make_step(qss::lattices::two_d::packed_square& lattice, double temperature, double J = 1.0)
+{
+    static_assert(
+        std::is_same_v<decltype(std::declval<random_t&>().get_bits()), word_t>,
+        "multispin update needs 64 random bits per call");
+    if (J < 0.0) {
+        throw std::logic_error("multispin update is for ferromagnets (J >= 0) : J = " + std::to_string(J));
+    }
+    static thread_local random_t rand{qss::random::get_seed()};
+    static thread_local double cached_temperature = 0.0;
+    static thread_local double cached_J = 0.0;
+    static thread_local probability_mask_t p4{};
+    static thread_local probability_mask_t p8{};
+    if (temperature != cached_temperature || J != cached_J) {
+        p4 = probability_mask_t{std::exp(-4.0 * J / temperature)};
+        p8 = probability_mask_t{std::exp(-8.0 * J / temperature)};
+        cached_temperature = temperature;
+        cached_J = J;
+    }
+    auto count = [](const word_t word) {
+        return static_cast<long long>(std::bitset<64>{word}.count());
+    };
+
+    const std::size_t size_y = lattice.sizes.y;
+    const std::size_t words_per_row = lattice.get_words_per_row();
+    // при нечётном числе слов в строке цвета чередуются внутри слова
+    constexpr word_t even_bits = 0x5555'5555'5555'5555u;
+    long long delta_magn = 0;
+    long long delta_energy = 0;
+    for (std::size_t color = 0; color < 2; ++color) {
+        for (std::size_t y = 0; y < size_y; ++y) {
+            word_t* row = lattice.get_row(y);
+            const word_t* upper = lattice.get_row((y + size_y - 1) % size_y);
+            const word_t* lower = lattice.get_row((y + 1) % size_y);
+            for (std::size_t i = 0; i < words_per_row; ++i) {
+                const bool same_parity = ((i + y) & 1u) == color;
+                const word_t color_mask = words_per_row % 2 == 0
+                    ? (same_parity ? ~word_t{0} : word_t{0})
+                    : (same_parity ? even_bits : ~even_bits);
+                if (color_mask == 0) {
+                    continue;
+                }
+                const word_t spins = row[i];
+                const word_t left = i > 0 ? row[i - 1]
+                                          : (row[words_per_row - 1] << 1) | (row[words_per_row - 1] >> 63);
+                const word_t right = i + 1 < words_per_row ? row[i + 1]
+                                                           : (row[0] >> 1) | (row[0] << 63);
+                const word_t a1 = spins ^ left;
+                const word_t a2 = spins ^ right;
+                const word_t a3 = spins ^ upper[i];
+                const word_t a4 = spins ^ lower[i];
+
+                // a = a1 + a2 + a3 + a4 по битовым плоскостям {bit2 bit1 bit0}
+                const word_t sum12 = a1 ^ a2;
+                const word_t carry12 = a1 & a2;
+                const word_t sum34 = a3 ^ a4;
+                const word_t carry34 = a3 & a4;
+                const word_t bit0 = sum12 ^ sum34;
+                const word_t carry0 = sum12 & sum34;
+                const word_t bit1 = carry12 ^ carry34 ^ carry0;
+                const word_t bit2 = (carry12 & carry34) | ((carry12 ^ carry34) & carry0);
+
+                const word_t is_0 = ~(bit0 | bit1 | bit2) & color_mask;
+                const word_t is_1 = bit0 & ~bit1 & ~bit2 & color_mask;
+                const word_t is_3 = bit0 & bit1;
+                const word_t is_4 = bit2;
+
+                word_t flip = (bit1 | bit2) & color_mask;
+                flip |= p4.generate(rand, is_1);
+                flip |= p8.generate(rand, is_0);
+                if (flip == 0) {
+                    continue;
+                }
+                row[i] = spins ^ flip;
+
+                delta_magn += 2 * (count(flip & ~spins) - count(flip & spins));
+                delta_energy += 8 * count(flip & is_0) + 4 * count(flip & is_1)
+                    - 4 * count(flip & is_3) - 8 * count(flip & is_4);
+            }
+        }
+    }
+    return std::pair{static_cast<double>(delta_magn), J * static_cast<double>(delta_energy)};
+}
+} // namespace multispin
+} // namespace algorithms
+} // namespace qss
+
+#endif
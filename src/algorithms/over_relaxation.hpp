@@ -0,0 +1,63 @@
+#ifndef OVER_RELAXATION_HPP_INCLUDED
+#define OVER_RELAXATION_HPP_INCLUDED
+
+#include "../models/heisenberg.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace qss {
+inline namespace algorithms {
+namespace over_relaxation {
+// переотражение определено только для непрерывных спинов
+template<typename value_t>
+inline constexpr bool is_applicable_v = std::is_same_v<value_t, qss::heisenberg::spin>;
+
+/*
+ * эффективное поле на спине по сумме соседей {sum} для линейной по спинам delta_h(sum, old, new)
+ * (как во всех примерах, в том числе с анизотропией diff.z *= (1 - Delta)):
+ * delta_h(sum, e_k, zero()) = (h_eff)_k, энергия спина s равна -(h_eff . s)
+ **/
+template<typename delta_h_t>
+[[nodiscard]] qss::heisenberg::magn
+get_effective_field(delta_h_t& delta_h, const qss::heisenberg::magn& sum)
+{
+    using spin_t = qss::heisenberg::spin;
+    constexpr auto zero = spin_t::zero();
+    return qss::heisenberg::magn{
+        delta_h(sum, spin_t{1.0, 0.0, 0.0}, zero),
+        delta_h(sum, spin_t{0.0, 1.0, 0.0}, zero),
+        delta_h(sum, spin_t{0.0, 0.0, 1.0}, zero)};
+}
+
+/*
+ * один микроканонический проход переотражений: каждый спин по порядку хранилища
+ * отражается относительно своего эффективного поля local_field_f(lattice, idx)
+ * (см. heisenberg::reflect). энергия не меняется, случайные числа и exp не нужны,
+ * поэтому проход дешевле шага Метрополиса; чередуется с ним для уменьшения автокорреляций,
+ * сам по себе не эргодичен.
+ * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии (0) }
+ **/
+template<typename lattice_t, typename local_field_f_t>
+std::pair<typename lattice_t::value_t::magn_t, double>
+make_step(lattice_t& lattice, local_field_f_t local_field_f)
+{
+    using value_t = typename lattice_t::value_t;
+    using idx_t = typename lattice_t::idx_t;
+    static_assert(is_applicable_v<value_t>, "over-relaxation is for Heisenberg spins");
+
+    typename value_t::magn_t delta_magn{};
+    const auto amount = lattice.get_amount_of_nodes();
+    for (idx_t idx = 0; idx < amount; ++idx) {
+        const auto old_spin = lattice.get_by_idx(idx);
+        const auto new_spin = qss::heisenberg::reflect(old_spin, local_field_f(lattice, idx));
+        lattice.set_by_idx(new_spin, idx);
+        delta_magn += new_spin - old_spin;
+    }
+    return std::pair{delta_magn, 0.0};
+}
+} // namespace over_relaxation
+} // namespace algorithms
+} // namespace qss
+
+#endif
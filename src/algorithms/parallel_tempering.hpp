@@ -0,0 +1,204 @@
+#ifndef PARALLEL_TEMPERING_HPP_INCLUDED
+#define PARALLEL_TEMPERING_HPP_INCLUDED
+
+#include "../random/mersenne.hpp"
+#include "../random/philox.hpp"
+#include "../random/random.hpp"
+#include "../utility/parallel.hpp"
+#include "../utility/thread_pool.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qss {
+inline namespace algorithms {
+namespace parallel_tempering {
+/*
+ * полная энергия multilayer_system по отслеживаемым energies (энергии плёнок на узел),
+ * без пересчёта по решётке. энергии должны быть абсолютными, то есть система хотя бы раз
+ * синхронизирована (synchronize() или synchronization_period > 0), иначе logic_error
+ **/
+struct tracked_energy_t {
+    template<typename system_t>
+    [[nodiscard]] double operator()(const system_t& system) const
+    {
+        if (!system.is_energy_absolute()) {
+            throw std::logic_error("replica energies are relative: synchronize() the system first");
+        }
+        double result = 0.0;
+        for (std::size_t idx = 0; idx < system.nanostructure.size(); ++idx) {
+            result += system.energies[idx] * static_cast<double>(system.nanostructure[idx].get_amount_of_nodes());
+        }
+        return result;
+    }
+};
+
+/*
+ * обмен репликами (parallel tempering).
+ * реплика -- независимая копия системы (решётка, multilayer_system и т.п.) при своей температуре.
+ * make_steps продвигает все реплики одновременно на пуле потоков,
+ * make_swaps пытается обменять температурами соседние по температуре реплики
+ * с вероятностью min(1, exp((1/T_i - 1/T_j) * (E_i - E_j))), чётные и нечётные пары по очереди.
+ * переставляются не сами системы, а номера: get_replica(t) -- реплика, находящаяся сейчас при temperatures[t].
+ * step_f(replica, T, rand) должна трогать только свою реплику и брать случайные числа из {rand}
+ * (например metropolis::make_step(..., rand)): это поток philox::make_stream(seed, номер реплики, 1, номер шага реплики),
+ * так что при одном сиде траектории не зависят от того, какой поток пула выполнил шаг.
+ * обмены используют свой поток (seed, 0, 0, 0).
+ * random_t должен строиться из qss::random::philox::philox4x32
+ **/
+template<typename replica_t, Random random_t = qss::random::mersenne::random_t<qss::random::philox::philox4x32>>
+class engine_t {
+    std::vector<replica_t> replicas;
+    std::vector<double> temperatures;
+    std::vector<std::size_t> replica_idxs; // номер реплики при temperatures[t]
+    std::vector<std::size_t> attempted;    // попытки обмена пары (t, t + 1)
+    std::vector<std::size_t> accepted;
+    std::vector<std::uint32_t> steps; // шагов, сделанных репликой, входит в ключ её потоков
+    std::uint64_t seed;
+    random_t rand;
+    std::size_t parity = 0;
+    qss::thread_pool pool;
+
+public:
+    engine_t(
+        std::vector<replica_t> replicas_,
+        std::vector<double> temperatures_,
+        const std::size_t threads_amount = qss::get_default_threads_amount(),
+        const std::uint64_t seed_ = qss::random::get_seed())
+        : replicas{std::move(replicas_)}
+        , temperatures{std::move(temperatures_)}
+        , replica_idxs(replicas.size())
+        , attempted(replicas.size(), 0)
+        , accepted(replicas.size(), 0)
+        , steps(replicas.size(), 0)
+        , seed{seed_}
+        , rand{qss::random::philox::make_stream(seed_, 0, 0, 0)}
+        , pool{threads_amount}
+    {
+        if (replicas.empty() || replicas.size() != temperatures.size()) {
+            throw std::logic_error(
+                "replicas and temperatures must be non-empty and of equal size : "
+                + std::to_string(replicas.size()) + " != " + std::to_string(temperatures.size()));
+        }
+        for (std::size_t t = 0; t < temperatures.size(); ++t) {
+            if (t > 0 && !(temperatures[t - 1] < temperatures[t])) {
+                throw std::logic_error("temperatures must be strictly increasing");
+            }
+            replica_idxs[t] = t;
+        }
+    }
+
+    [[nodiscard]] std::size_t get_replicas_amount() const noexcept
+    {
+        return replicas.size();
+    }
+    [[nodiscard]] const std::vector<double>& get_temperatures() const noexcept
+    {
+        return temperatures;
+    }
+    [[nodiscard]] replica_t& get_replica(const std::size_t t) noexcept
+    {
+        return replicas[replica_idxs[t]];
+    }
+    [[nodiscard]] const replica_t& get_replica(const std::size_t t) const noexcept
+    {
+        return replicas[replica_idxs[t]];
+    }
+    // доля принятых обменов между temperatures[t] и temperatures[t + 1]
+    [[nodiscard]] double get_acceptance_rate(const std::size_t t) const noexcept
+    {
+        return attempted[t] == 0
+            ? 0.0
+            : static_cast<double>(accepted[t]) / static_cast<double>(attempted[t]);
+    }
+
+    /*
+     * {steps_amount} вызовов step_f(replica, T, rand) для каждой реплики при её текущей температуре,
+     * реплики обрабатываются параллельно.
+     * исключение из step_f пробрасывается после завершения шагов всех реплик
+     **/
+    template<typename step_f_t>
+    void make_steps(step_f_t step_f, const std::size_t steps_amount = 1)
+    {
+        std::vector<std::future<void>> results{};
+        results.reserve(replicas.size());
+        for (std::size_t t = 0; t < replicas.size(); ++t) {
+            results.push_back(pool.submit([this, &step_f, steps_amount, t]() {
+                const auto replica_idx = replica_idxs[t];
+                auto& replica = replicas[replica_idx];
+                for (std::size_t step = 0; step < steps_amount; ++step) {
+                    random_t replica_rand{qss::random::philox::make_stream(
+                        seed, static_cast<std::uint32_t>(replica_idx), 1, steps[replica_idx]++)};
+                    step_f(replica, temperatures[t], replica_rand);
+                }
+            }));
+        }
+        // задачи держат step_f и this: сначала дожидаемся всех, потом пробрасываем первое исключение
+        for (auto& result : results) {
+            result.wait();
+        }
+        for (auto& result : results) {
+            result.get();
+        }
+    }
+
+    /*
+     * попытки обмена для пар (t, t + 1) одной чётности, чётность чередуется от вызова к вызову.
+     * energy_f(replica) -- полная энергия реплики в тех же единицах, что и температура,
+     * по умолчанию -- отслеживаемая энергия multilayer_system (tracked_energy_t)
+     * возвращает число принятых обменов
+     **/
+    template<typename energy_f_t = tracked_energy_t>
+    std::size_t make_swaps(energy_f_t energy_f = {})
+    {
+        std::vector<double> energies(replicas.size());
+        for (std::size_t t = 0; t < replicas.size(); ++t) {
+            energies[t] = energy_f(std::as_const(replicas[replica_idxs[t]]));
+        }
+        std::size_t result = 0;
+        for (std::size_t t = parity; t + 1 < replicas.size(); t += 2) {
+            ++attempted[t];
+            const double delta
+                = (1.0 / temperatures[t] - 1.0 / temperatures[t + 1]) * (energies[t] - energies[t + 1]);
+            if (delta >= 0.0 || rand() < std::exp(delta)) {
+                std::swap(replica_idxs[t], replica_idxs[t + 1]);
+                ++accepted[t];
+                ++result;
+            }
+        }
+        parity ^= 1;
+        return result;
+    }
+
+    // {swaps_amount} раз: {steps_between_swaps} шагов всех реплик, затем попытка обмена
+    template<typename step_f_t, typename energy_f_t, typename = std::enable_if_t<!std::is_arithmetic_v<energy_f_t>>>
+    void run(
+        step_f_t step_f,
+        energy_f_t energy_f,
+        const std::size_t swaps_amount,
+        const std::size_t steps_between_swaps = 1)
+    {
+        for (std::size_t swap = 0; swap < swaps_amount; ++swap) {
+            make_steps(step_f, steps_between_swaps);
+            make_swaps(energy_f);
+        }
+    }
+    // то же с энергиями по умолчанию (tracked_energy_t)
+    template<typename step_f_t>
+    void run(step_f_t step_f, const std::size_t swaps_amount, const std::size_t steps_between_swaps = 1)
+    {
+        run(step_f, tracked_energy_t{}, swaps_amount, steps_between_swaps);
+    }
+};
+} // namespace parallel_tempering
+} // namespace algorithms
+} // namespace qss
+
+#endif
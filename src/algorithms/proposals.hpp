@@ -0,0 +1,76 @@
+#ifndef PROPOSALS_HPP_INCLUDED
+#define PROPOSALS_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+
+namespace qss {
+inline namespace algorithms {
+namespace metropolis {
+/*
+ * способы предложить новое значение узла для make_step.
+ * proposal(old_value, rand) -- новое значение вместо {old_value},
+ * proposal.adapt(accepted, proposed) вызывается в конце каждого шага Монте-Карло,
+ * proposal.tune(sweeps) разрешает подстройку на ближайшие {sweeps} шагов (термализация)
+ **/
+
+// новое значение не зависит от старого: value_t::generate(rand)
+struct uniform_proposal_t {
+    template<typename value_t, typename random_t>
+    [[nodiscard]] value_t operator()(const value_t&, random_t& rand) const noexcept
+    {
+        return value_t::generate(rand);
+    }
+    void adapt(std::size_t, std::size_t) noexcept {}
+    void tune(std::size_t) noexcept {}
+};
+
+/*
+ * новый спин равномерно в конусе вокруг старого (value_t::generate_near, модель Гейзенберга):
+ * width = 1 - cos(половины угла раствора), из [min_width; 2], при width = 2 -- вся сфера.
+ * во время подстройки после каждого шага width меняется так,
+ * чтобы доля принятых предложений приближалась к target_acceptance.
+ * подстройка нарушает детальный баланс, поэтому по умолчанию выключена:
+ * tune(sweeps) включает её на {sweeps} шагов термализации, затем ширина замораживается.
+ * is_adaptive = true подстраивает ширину всегда, пока его не сбросят
+ **/
+struct cone_proposal_t {
+    static constexpr double min_width = 1e-6;
+    static constexpr double max_width = 2.0;
+
+    double width{max_width};
+    double target_acceptance{0.5};
+    bool is_adaptive{false};
+    std::size_t adaptive_sweeps{0}; // сколько ещё шагов подстраивать ширину (см. tune)
+    double acceptance_rate{0.0};    // доля принятых за последний шаг
+
+    template<typename value_t, typename random_t>
+    [[nodiscard]] value_t operator()(const value_t& old_value, random_t& rand) const noexcept
+    {
+        return value_t::generate_near(old_value, width, rand);
+    }
+    void adapt(const std::size_t accepted, const std::size_t proposed) noexcept
+    {
+        if (proposed == 0) {
+            return;
+        }
+        acceptance_rate = static_cast<double>(accepted) / static_cast<double>(proposed);
+        if (is_adaptive || adaptive_sweeps != 0) {
+            // за шаг ширина меняется не более чем вдвое
+            const double factor = std::clamp(acceptance_rate / target_acceptance, 0.5, 2.0);
+            width = std::clamp(width * factor, min_width, max_width);
+        }
+        if (adaptive_sweeps != 0) {
+            --adaptive_sweeps;
+        }
+    }
+    void tune(const std::size_t sweeps) noexcept
+    {
+        adaptive_sweeps = sweeps;
+    }
+};
+} // namespace metropolis
+} // namespace algorithms
+} // namespace qss
+
+#endif
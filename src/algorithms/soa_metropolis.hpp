@@ -0,0 +1,226 @@
+#ifndef SOA_METROPOLIS_HPP_INCLUDED
+#define SOA_METROPOLIS_HPP_INCLUDED
+
+#include "../lattices/soa_lattice.hpp"
+#include "../models/heisenberg.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/random.hpp"
+#include "checkerboard.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace qss {
+inline namespace algorithms {
+namespace soa_metropolis {
+/*
+ * число узлов, обрабатываемых одновременно, и набор инструкций суммирования соседей.
+ * AVX-512/AVX2 выбираются только если компилятор нацелен на них
+ * (cmake -DQSS_NATIVE=ON, то есть -march=native, или -mavx2 -mfma / -mavx512f),
+ * иначе используется обычный цикл
+ **/
+#if defined(__AVX512F__)
+inline constexpr std::size_t lanes = 8;
+inline constexpr const char* instruction_set = "avx512";
+#elif defined(__AVX2__)
+inline constexpr std::size_t lanes = 4;
+inline constexpr const char* instruction_set = "avx2";
+#else
+inline constexpr std::size_t lanes = 4;
+inline constexpr const char* instruction_set = "scalar";
+#endif
+
+namespace detail {
+/*
+ * изменение энергии для {lanes} подряд идущих узлов начиная с {first}:
+ * dE = J * h . ((s_old - s_new) * anisotropy), h -- сумма соседей
+ **/
+template<typename lattice_t>
+void calculate_delta_energies(
+    qss::lattices::soa_lattice<lattice_t>& lattice,
+    const std::size_t first,
+    const std::array<double, lanes>& new_xs,
+    const std::array<double, lanes>& new_ys,
+    const std::array<double, lanes>& new_zs,
+    const qss::heisenberg::magn& weights,
+    std::array<double, lanes>& delta_energies) noexcept
+{
+    const double* xs = lattice.get_xs();
+    const double* ys = lattice.get_ys();
+    const double* zs = lattice.get_zs();
+    constexpr auto neighbours_amount = qss::lattices::soa_lattice<lattice_t>::neighbours_amount;
+#if defined(__AVX512F__)
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d hx = zero;
+    __m512d hy = zero;
+    __m512d hz = zero;
+    for (std::size_t j = 0; j < neighbours_amount; ++j) {
+        const __m256i idx = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(lattice.get_neighbours(j) + first));
+        hx = _mm512_add_pd(hx, _mm512_mask_i32gather_pd(zero, 0xFF, idx, xs, 8));
+        hy = _mm512_add_pd(hy, _mm512_mask_i32gather_pd(zero, 0xFF, idx, ys, 8));
+        hz = _mm512_add_pd(hz, _mm512_mask_i32gather_pd(zero, 0xFF, idx, zs, 8));
+    }
+    const __m512d dx = _mm512_mul_pd(
+        _mm512_sub_pd(_mm512_loadu_pd(xs + first), _mm512_loadu_pd(new_xs.data())),
+        _mm512_set1_pd(weights.x));
+    const __m512d dy = _mm512_mul_pd(
+        _mm512_sub_pd(_mm512_loadu_pd(ys + first), _mm512_loadu_pd(new_ys.data())),
+        _mm512_set1_pd(weights.y));
+    const __m512d dz = _mm512_mul_pd(
+        _mm512_sub_pd(_mm512_loadu_pd(zs + first), _mm512_loadu_pd(new_zs.data())),
+        _mm512_set1_pd(weights.z));
+    __m512d dE = _mm512_mul_pd(hx, dx);
+    dE = _mm512_fmadd_pd(hy, dy, dE);
+    dE = _mm512_fmadd_pd(hz, dz, dE);
+    _mm512_storeu_pd(delta_energies.data(), dE);
+#elif defined(__AVX2__)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d hx = zero;
+    __m256d hy = zero;
+    __m256d hz = zero;
+    for (std::size_t j = 0; j < neighbours_amount; ++j) {
+        const __m128i idx
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lattice.get_neighbours(j) + first));
+        hx = _mm256_add_pd(hx, _mm256_mask_i32gather_pd(zero, xs, idx, all, 8));
+        hy = _mm256_add_pd(hy, _mm256_mask_i32gather_pd(zero, ys, idx, all, 8));
+        hz = _mm256_add_pd(hz, _mm256_mask_i32gather_pd(zero, zs, idx, all, 8));
+    }
+    const __m256d dx = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(xs + first), _mm256_loadu_pd(new_xs.data())),
+        _mm256_set1_pd(weights.x));
+    const __m256d dy = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(ys + first), _mm256_loadu_pd(new_ys.data())),
+        _mm256_set1_pd(weights.y));
+    const __m256d dz = _mm256_mul_pd(
+        _mm256_sub_pd(_mm256_loadu_pd(zs + first), _mm256_loadu_pd(new_zs.data())),
+        _mm256_set1_pd(weights.z));
+    __m256d dE = _mm256_mul_pd(hx, dx);
+    dE = _mm256_add_pd(dE, _mm256_mul_pd(hy, dy));
+    dE = _mm256_add_pd(dE, _mm256_mul_pd(hz, dz));
+    _mm256_storeu_pd(delta_energies.data(), dE);
+#else
+    std::array<double, lanes> hx{};
+    std::array<double, lanes> hy{};
+    std::array<double, lanes> hz{};
+    for (std::size_t j = 0; j < neighbours_amount; ++j) {
+        const auto* idx = lattice.get_neighbours(j) + first;
+        for (std::size_t k = 0; k < lanes; ++k) {
+            hx[k] += xs[idx[k]];
+            hy[k] += ys[idx[k]];
+            hz[k] += zs[idx[k]];
+        }
+    }
+    for (std::size_t k = 0; k < lanes; ++k) {
+        delta_energies[k] = hx[k] * (xs[first + k] - new_xs[k]) * weights.x
+            + hy[k] * (ys[first + k] - new_ys[k]) * weights.y
+            + hz[k] * (zs[first + k] - new_zs[k]) * weights.z;
+    }
+#endif
+}
+
+template<typename lattice_t>
+[[nodiscard]] double calculate_delta_energy(
+    qss::lattices::soa_lattice<lattice_t>& lattice,
+    const std::size_t idx,
+    const qss::heisenberg::spin& new_spin,
+    const qss::heisenberg::magn& weights) noexcept
+{
+    const double* xs = lattice.get_xs();
+    const double* ys = lattice.get_ys();
+    const double* zs = lattice.get_zs();
+    double hx = 0.0;
+    double hy = 0.0;
+    double hz = 0.0;
+    for (std::size_t j = 0; j < qss::lattices::soa_lattice<lattice_t>::neighbours_amount; ++j) {
+        const auto neig = static_cast<std::size_t>(lattice.get_neighbours(j)[idx]);
+        hx += xs[neig];
+        hy += ys[neig];
+        hz += zs[neig];
+    }
+    return hx * (xs[idx] - new_spin.x) * weights.x + hy * (ys[idx] - new_spin.y) * weights.y
+        + hz * (zs[idx] - new_spin.z) * weights.z;
+}
+} // namespace detail
+
+/*
+ * шаг Метрополиса для гейзенберговских спинов в soa_lattice.
+ * узлы обходятся по цветам (см. checkerboard.hpp): внутри цвета соседей нет,
+ * поэтому {lanes} подряд идущих узлов обрабатываются одновременно:
+ * суммы соседей и изменения энергии считаются gather-инструкциями AVX-512/AVX2 (или обычным циклом).
+ * векторизовано только это: новые спины генерируются, а предложения принимаются
+ * или отклоняются по одному, скалярно.
+ * anisotropy -- множители компонент разности спинов, как в примерах с Delta;
+ * изменение энергии: J * h . ((s_old - s_new) * anisotropy)
+ * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+ **/
+template<typename lattice_t, Random random_t = qss::random::mersenne::random_t<>>
+std::pair<qss::heisenberg::magn, double> make_step(
+    qss::lattices::soa_lattice<lattice_t>& lattice,
+    const std::vector<qss::checkerboard::color_class_t>& color_classes,
+    double temperature,
+    double J = 1.0,
+    const qss::heisenberg::magn& anisotropy = {1.0, 1.0, 1.0})
+{
+    using spin_t = qss::heisenberg::spin;
+    static thread_local random_t rand{qss::random::get_seed()};
+
+    double* xs = lattice.get_xs();
+    double* ys = lattice.get_ys();
+    double* zs = lattice.get_zs();
+    qss::heisenberg::magn delta_magn{};
+    double delta_energy = 0.0;
+    auto try_accept = [&](const std::size_t idx, const spin_t& new_spin, const double dE) {
+        if (dE < 0.0 || rand() < std::exp(-dE / temperature)) {
+            delta_magn.x += new_spin.x - xs[idx];
+            delta_magn.y += new_spin.y - ys[idx];
+            delta_magn.z += new_spin.z - zs[idx];
+            delta_energy += dE;
+            lattice.set_by_idx(new_spin, idx);
+        }
+    };
+
+    const qss::heisenberg::magn weights = J * anisotropy;
+    std::array<double, lanes> new_xs{};
+    std::array<double, lanes> new_ys{};
+    std::array<double, lanes> new_zs{};
+    std::array<double, lanes> delta_energies{};
+    for (const auto& color_class : color_classes) {
+        for (const auto& range : color_class) {
+            std::size_t idx = range.begin;
+            if (range.stride == 1) {
+                for (; idx + lanes <= range.end; idx += lanes) {
+                    for (std::size_t k = 0; k < lanes; ++k) {
+                        const auto new_spin = spin_t::generate(rand);
+                        new_xs[k] = new_spin.x;
+                        new_ys[k] = new_spin.y;
+                        new_zs[k] = new_spin.z;
+                    }
+                    detail::calculate_delta_energies(
+                        lattice, idx, new_xs, new_ys, new_zs, weights, delta_energies);
+                    for (std::size_t k = 0; k < lanes; ++k) {
+                        try_accept(idx + k, spin_t{new_xs[k], new_ys[k], new_zs[k]}, delta_energies[k]);
+                    }
+                }
+            }
+            for (; idx < range.end; idx += range.stride) {
+                const auto new_spin = spin_t::generate(rand);
+                try_accept(idx, new_spin, detail::calculate_delta_energy(lattice, idx, new_spin, weights));
+            }
+        }
+    }
+    return std::pair{delta_magn, delta_energy};
+}
+} // namespace soa_metropolis
+} // namespace algorithms
+} // namespace qss
+
+#endif
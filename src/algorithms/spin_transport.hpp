@@ -9,9 +9,17 @@
 #include "../systems/film.hpp"
 #include "../systems/multilayer.hpp"
 #include "../systems/multilayer_system.hpp"
+#include "../utility/statistics.hpp"
 
-#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace qss {
 inline namespace algorithms {
@@ -118,24 +126,27 @@ inline typename proxy_spin::magn_t operator/(const proxy_spin& lhs, const double
     return typename proxy_spin::magn_t(lhs) / rhs;
 }
 
-template<template<typename> class lattice_t, typename spin_t>
+template<
+    template<typename> class lattice_t,
+    typename spin_t,
+    typename proposal_t = qss::algorithms::metropolis::uniform_proposal_t>
 // requires qss::nanostructures::ThreeD_Lattice<lattice_t<spin_t>>
 using nanostructure_type
-    = qss::nanostructures::multilayer_system<qss::nanostructures::multilayer<lattice_t<spin_t>>>;
+    = qss::nanostructures::multilayer_system<qss::nanostructures::multilayer<lattice_t<spin_t>>, proposal_t>;
 
 /*  proxy структура ТОЛЬКО для использования в функции spin_transport
  *  содержит указатели на нужные значения спина, и электронных плотностей
  *  spin_component_name принимает значения x, y или z,
  *  чтобы указать какую составляющую спина использовать далее
  **/
-template<typename old_spin_t, template<typename = old_spin_t> class lattice_t>
-[[nodiscard]] nanostructure_type<lattice_t, proxy_spin> prepare_proxy_structure(
-    nanostructure_type<lattice_t, old_spin_t>& system,
+template<typename old_spin_t, template<typename = old_spin_t> class lattice_t, typename proposal_t>
+[[nodiscard]] nanostructure_type<lattice_t, proxy_spin, proposal_t> prepare_proxy_structure(
+    nanostructure_type<lattice_t, old_spin_t, proposal_t>& system,
     typename qss::nanostructures::multilayer<lattice_t<qss::models::electron_dencity>>& n_up,
     typename qss::nanostructures::multilayer<lattice_t<qss::models::electron_dencity>>& n_down,
     char spin_component_name = 'x')
 {
-    auto result = copy_structure<proxy_spin, old_spin_t, lattice_t>(system);
+    auto result = copy_structure<proxy_spin, old_spin_t, lattice_t, proposal_t>(system);
     {
         auto result_iter = result.nanostructure.begin();
         auto system__iter = system.nanostructure.begin();
@@ -170,61 +181,295 @@ struct result_t {
     double down;
 };
 
-template<template<typename> class film_t, typename random_t = qss::random::mersenne::random_t<>>
-result_t perform(nanostructure_type<film_t, proxy_spin>& system) noexcept
-{
-    result_t result{};
-    auto layers = system.nanostructure;
-    const auto amount = std::accumulate(
-        layers.begin(),
-        layers.end(),
-        layers.begin()->get_amount_of_nodes(),
-        []([[maybe_unused]] auto first, auto second) { return second.get_amount_of_nodes(); });
-    for (auto _ = 0u; _ < amount; ++_) {
-        const auto coord = layers.template get_random_coord<random_t>();
-        double E1 = layers.get_sum_of_closest_neighbours(coord)
-            - layers[static_cast<std::size_t>(coord.film_coord.z)].J * layers.get(coord);
-
-        auto next_coord = coord;
-        auto next_film_coord = coord.film_coord;
-        auto next_coord_J = layers[coord.idx].J;
-        if (next_film_coord.z == layers[coord.idx].get_last_z(coord.film_coord)) {
-            next_film_coord.z = 0;
-            next_coord
-                = {static_cast<typename decltype(system.nanostructure)::coords_t::size_type>(
-                       coord.idx + 1),
-                   next_film_coord};
-            next_coord_J = layers.get_J_interlayers()[coord.idx];
-        } else {
-            next_film_coord.z += 1;
-            next_coord = {coord.idx, next_film_coord};
+/*
+ * перенос электронов, данные -- структура массивов по сквозному номеру узла
+ * (узлы плёнок подряд, внутри плёнки -- в порядке её хранилища):
+ * spins -- выбранная компонента спина, up и down -- электронные плотности.
+ * геометрия (соседи внутри плёнки, соседи из соседних плёнок с весами J_interlayers,
+ * следующий по z узел) строится один раз при создании, плотности хранит сам движок,
+ * компонента спина перечитывается из системы в начале каждого perform().
+ * движок хранит ссылку на систему, она должна жить дольше движка
+ **/
+template<typename system_t, typename random_t = qss::random::mersenne::random_t<>>
+class engine_t {
+    using multilayer_t = decltype(system_t::nanostructure);
+    using film_t = typename multilayer_t::film_t;
+    using value_t = typename film_t::value_t;
+    static constexpr std::size_t neighbours_amount = film_t::neighbours_amount;
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+    struct site_t {
+        std::uint32_t next;         // следующий по z узел или npos (за последней плёнкой)
+        std::uint32_t upper;        // сосед из следующей плёнки или npos
+        std::uint32_t lower;        // сосед из предыдущей плёнки или npos
+        std::uint8_t film_idx;
+        std::uint8_t outer_amount;  // число соседей за пределами плёнки
+        bool is_last_z;             // последний слой своей плёнки
+    };
+
+    system_t& system;
+    char spin_component_name;
+    std::vector<std::size_t> offsets{};       // номер первого узла каждой плёнки, в конце -- число узлов
+    std::vector<std::uint32_t> neighbours{};  // по neighbours_amount соседей узла внутри плёнки или npos
+    std::vector<site_t> sites{};
+    std::vector<double> Js{};                 // обменные интегралы плёнок
+    std::vector<double> J_interlayers{};
+    std::vector<double> spins{};
+    std::vector<double> up{};
+    std::vector<double> down{};
+    random_t rand{qss::random::get_seed()};
+
+    // значение proxy_spin: разность плотностей со знаком компоненты спина
+    [[nodiscard]] double get_value(const std::size_t site) const noexcept
+    {
+        return spins[site] > 0.0 ? up[site] - down[site] : down[site] - up[site];
+    }
+    [[nodiscard]] double get_sum_of_closest_neighbours(const std::size_t site) const noexcept
+    {
+        const auto& data = sites[site];
+        double sum = 0.0;
+        const auto* row = neighbours.data() + site * neighbours_amount;
+        for (std::size_t i = 0; i < neighbours_amount; ++i) {
+            if (row[i] != npos) {
+                sum += get_value(row[i]);
+            }
         }
-        double E2{};
-        if (coord.film_coord.z == layers[coord.idx].get_last_z(coord.film_coord)) {
-            E2 = 0.0;
-        } else {
-            E2 = layers.get_sum_of_closest_neighbours(next_coord)
-                - next_coord_J * layers.get(next_coord);
-            E2 -= next_coord_J * layers.get(coord);
-            E1 -= next_coord_J * layers.get(next_coord);
+        sum *= Js[data.film_idx];
+        if (data.upper != npos) {
+            sum += (J_interlayers[data.film_idx] * data.outer_amount) * get_value(data.upper);
+        }
+        if (data.lower != npos) {
+            sum += (J_interlayers[data.film_idx - 1u] * data.outer_amount) * get_value(data.lower);
+        }
+        return sum;
+    }
+
+public:
+    /*
+     * spin_component_name -- x, y или z, какая компонента спина задаёт знак (как в prepare_proxy_structure),
+     * для системы из proxy_spin не используется
+     **/
+    explicit engine_t(system_t& system_, char spin_component_name_ = 'x')
+        : system{system_}
+        , spin_component_name{spin_component_name_}
+    {
+        if (spin_component_name != 'x' && spin_component_name != 'y' && spin_component_name != 'z') {
+            throw std::logic_error(
+                "spin_component_name should be 'x' or 'y' or 'z' but was : "
+                + std::string{spin_component_name});
         }
-        const auto delta_E = E2 - E1;
-        static random_t rand{qss::random::get_seed()};
-        if (delta_E < 0.0 || rand() < std::exp(-delta_E / system.T)) {
-            auto chosen = layers.get(coord);
-            result.up += layers.get(coord).get_up();
-            result.down += layers.get(coord).get_down();
-            if (next_coord.idx < layers.size()) {
-                const auto next = layers.get(next_coord);
-                chosen.set_up(
-                    typename qss::models::electron_dencity{chosen.get_up() + next.get_up()});
-                chosen.set_down(
-                    typename qss::models::electron_dencity{chosen.get_down() + next.get_down()});
-                layers.set(next_coord, chosen);
+        const auto& layers = system.nanostructure;
+        offsets.assign(layers.size() + 1, 0);
+        for (std::size_t idx = 0; idx < layers.size(); ++idx) {
+            offsets[idx + 1] = offsets[idx] + layers[idx].get_amount_of_nodes();
+            Js.push_back(layers[idx].J);
+        }
+        J_interlayers = layers.get_J_interlayers();
+        const auto amount = offsets.back();
+        if (amount >= npos) {
+            throw std::out_of_range("too many nodes for spin transport : " + std::to_string(amount));
+        }
+        neighbours.reserve(amount * neighbours_amount);
+        sites.reserve(amount);
+        for (std::size_t idx = 0; idx < layers.size(); ++idx) {
+            const auto& film = layers[idx];
+            const auto table = make_neighbours_table(film);
+            const bool has_upper = idx + 1 < layers.size();
+            const bool has_lower = idx != 0;
+            for (std::size_t node = 0; node < film.get_amount_of_nodes(); ++node) {
+                site_t site{npos, npos, npos, static_cast<std::uint8_t>(idx), 0, false};
+                for (const auto neig : table[node]) {
+                    if (neig == decltype(table)::npos) {
+                        neighbours.push_back(npos);
+                        ++site.outer_amount;
+                    } else {
+                        neighbours.push_back(static_cast<std::uint32_t>(offsets[idx] + neig));
+                    }
+                }
+                auto coord = film.get_coords(node);
+                if (site.outer_amount != 0 && has_upper) {
+                    const auto neig = get_closest_neigbour_from_upper_film(layers[idx + 1], coord);
+                    if (neig) {
+                        site.upper = static_cast<std::uint32_t>(offsets[idx + 1] + layers[idx + 1].get_idx(neig.value()));
+                    }
+                }
+                if (site.outer_amount != 0 && has_lower) {
+                    const auto neig = get_closest_neigbour_from_lower_film(layers[idx - 1], coord);
+                    if (neig) {
+                        site.lower = static_cast<std::uint32_t>(offsets[idx - 1] + layers[idx - 1].get_idx(neig.value()));
+                    }
+                }
+                site.is_last_z = coord.z == film.get_last_z(coord);
+                if (!site.is_last_z) {
+                    coord.z += 1;
+                    site.next = static_cast<std::uint32_t>(offsets[idx] + film.get_idx(coord));
+                } else if (has_upper) {
+                    coord.z = 0;
+                    site.next = static_cast<std::uint32_t>(offsets[idx + 1] + layers[idx + 1].get_idx(coord));
+                }
+                sites.push_back(site);
             }
-            chosen.set_up(typename qss::models::electron_dencity{0.0});
-            chosen.set_down(typename qss::models::electron_dencity{0.0});
-            layers.set(coord, chosen);
+        }
+        spins.assign(amount, 0.0);
+        up.assign(amount, 0.0);
+        down.assign(amount, 0.0);
+        load_spins();
+    }
+
+    [[nodiscard]] std::size_t get_amount_of_nodes() const noexcept
+    {
+        return sites.size();
+    }
+    // сквозной номер узла {node_idx} плёнки {film_idx}
+    [[nodiscard]] std::size_t get_site(const std::size_t film_idx, const std::size_t node_idx) const noexcept
+    {
+        return offsets[film_idx] + node_idx;
+    }
+    // плотности по сквозному номеру узла
+    [[nodiscard]] std::vector<double>& get_up() noexcept
+    {
+        return up;
+    }
+    [[nodiscard]] std::vector<double>& get_down() noexcept
+    {
+        return down;
+    }
+    [[nodiscard]] const std::vector<double>& get_up() const noexcept
+    {
+        return up;
+    }
+    [[nodiscard]] const std::vector<double>& get_down() const noexcept
+    {
+        return down;
+    }
+
+    // плотности во всей плёнке {film_idx}
+    void fill(const std::size_t film_idx, const double up_value, const double down_value) noexcept
+    {
+        std::fill(up.begin() + static_cast<std::ptrdiff_t>(offsets[film_idx]),
+                  up.begin() + static_cast<std::ptrdiff_t>(offsets[film_idx + 1]), up_value);
+        std::fill(down.begin() + static_cast<std::ptrdiff_t>(offsets[film_idx]),
+                  down.begin() + static_cast<std::ptrdiff_t>(offsets[film_idx + 1]), down_value);
+    }
+    /*
+     * плотности в атомной плоскости {z} плёнки {film_idx}:
+     * чётные плоскости -- подрешётки 0 и 1 со слоем z / 2, нечётные -- 2 и 3
+     **/
+    void fill_plane(const std::size_t film_idx, const unsigned int z, const double up_value, const double down_value)
+    {
+        const auto& film = system.nanostructure[film_idx];
+        for (std::size_t node = 0; node < film.get_amount_of_nodes(); ++node) {
+            const auto coord = film.get_coords(node);
+            const bool is_even_plane = coord.w < 2;
+            if (is_even_plane == (z % 2 == 0) && static_cast<unsigned int>(coord.z) == z / 2) {
+                up[offsets[film_idx] + node] = up_value;
+                down[offsets[film_idx] + node] = down_value;
+            }
+        }
+    }
+
+    // перечитывает компоненту спина из системы
+    void load_spins() noexcept
+    {
+        const auto& layers = system.nanostructure;
+        for (std::size_t idx = 0; idx < layers.size(); ++idx) {
+            const auto& film = layers[idx];
+            auto* first = spins.data() + offsets[idx];
+            for (std::size_t node = 0; node < film.get_amount_of_nodes(); ++node) {
+                const auto spin = film.get_by_idx(node);
+                if constexpr (std::is_same_v<value_t, proxy_spin>) {
+                    first[node] = spin.get_val();
+                } else {
+                    first[node] = spin_component_name == 'x' ? spin.x
+                        : spin_component_name == 'y'         ? spin.y
+                                                             : spin.z;
+                }
+            }
+        }
+    }
+
+    /*
+     * один шаг: столько попыток перескока, сколько узлов в структуре.
+     * электроны выбранного узла целиком переходят в следующий по z узел
+     * (за последней плёнкой -- уходят из структуры).
+     * возвращает перенесённые плотности up и down
+     **/
+    result_t perform() noexcept
+    {
+        load_spins();
+        result_t result{};
+        const auto amount = static_cast<int>(sites.size());
+        QSS_STATISTICS_ONLY(auto& statistics = qss::get_thread_statistics(); qss::stopwatch_t stopwatch{};)
+        for (int _ = 0; _ < amount; ++_) {
+            QSS_STATISTICS_ONLY(++statistics.proposals;)
+            const auto chosen = static_cast<std::size_t>(rand(0, amount));
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.random_ns);)
+            const auto& site = sites[chosen];
+            const double J = Js[site.film_idx];
+            const double value = get_value(chosen);
+            double E1 = get_sum_of_closest_neighbours(chosen) - J * value;
+            double E2 = 0.0;
+            if (!site.is_last_z) {
+                const double next_value = get_value(site.next);
+                E2 = get_sum_of_closest_neighbours(site.next) - J * next_value;
+                E2 -= J * value;
+                E1 -= J * next_value;
+            }
+            const auto delta_E = E2 - E1;
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.neighbours_ns);)
+            if (delta_E < 0.0 || rand() < std::exp(-delta_E / system.T)) {
+                QSS_STATISTICS_ONLY(
+                    if (up[chosen] + down[chosen] == 0.0) {
+                        statistics.reject(qss::rejection_t::empty_site);
+                    } else {
+                        ++statistics.acceptances;
+                    })
+                result.up += up[chosen];
+                result.down += down[chosen];
+                if (site.next != npos) {
+                    up[site.next] += up[chosen];
+                    down[site.next] += down[chosen];
+                }
+                up[chosen] = 0.0;
+                down[chosen] = 0.0;
+            } else {
+                QSS_STATISTICS_ONLY(statistics.reject(qss::rejection_t::boltzmann);)
+            }
+            QSS_STATISTICS_ONLY(stopwatch.lap(statistics.acceptance_ns);)
+        }
+        return result;
+    }
+};
+
+/*
+ * один шаг переноса по proxy структуре (см. prepare_proxy_structure):
+ * плотности собираются из proxy_spin в движок и после шага записываются обратно.
+ * геометрия строится при каждом вызове, для повторных шагов лучше держать engine_t
+ **/
+template<
+    template<typename> class film_t,
+    typename random_t = qss::random::mersenne::random_t<>,
+    typename proposal_t = qss::algorithms::metropolis::uniform_proposal_t>
+result_t perform(nanostructure_type<film_t, proxy_spin, proposal_t>& system)
+{
+    engine_t<nanostructure_type<film_t, proxy_spin, proposal_t>, random_t> engine{system};
+    auto& up = engine.get_up();
+    auto& down = engine.get_down();
+    for (std::size_t idx = 0; idx < system.nanostructure.size(); ++idx) {
+        const auto& film = system.nanostructure[idx];
+        for (std::size_t node = 0; node < film.get_amount_of_nodes(); ++node) {
+            const auto spin = film.get_by_idx(node);
+            up[engine.get_site(idx, node)] = spin.get_up();
+            down[engine.get_site(idx, node)] = spin.get_down();
+        }
+    }
+    const auto result = engine.perform();
+    for (std::size_t idx = 0; idx < system.nanostructure.size(); ++idx) {
+        const auto& film = system.nanostructure[idx];
+        for (std::size_t node = 0; node < film.get_amount_of_nodes(); ++node) {
+            auto spin = film.get_by_idx(node);
+            spin.set_up(typename qss::models::electron_dencity{up[engine.get_site(idx, node)]});
+            spin.set_down(typename qss::models::electron_dencity{down[engine.get_site(idx, node)]});
         }
     }
     return result;
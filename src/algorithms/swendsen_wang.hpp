@@ -0,0 +1,231 @@
+#ifndef SWENDSEN_WANG_HPP_INCLUDED
+#define SWENDSEN_WANG_HPP_INCLUDED
+
+#include "../lattices/neighbours_table.hpp"
+#include "../models/ising.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/philox.hpp"
+#include "../random/random.hpp"
+#include "../utility/parallel.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qss {
+inline namespace algorithms {
+namespace swendsen_wang {
+/*
+ * кластерный алгоритм Свендсена-Ванга для модели Изинга (J > 0).
+ * за один шаг разбивает всю решётку на кластеры и переворачивает каждый с вероятностью 1/2.
+ * связи строятся параллельно, кластеры помечаются конкурентным union-find
+ * (объединение корней через compare_exchange, поиск с делением пути пополам).
+ * соседи берутся из таблицы, поэтому подходит для квадратной и ГЦК решёток и плёнок.
+ * случайные числа -- счётчиковые потоки (random/philox.hpp) по блокам узлов и номеру шага,
+ * так что при одном сиде кластеры и перевороты не зависят от числа потоков.
+ * потоки создаются один раз вместе с движком (qss::thread_team) и переиспользуются всеми проходами
+ **/
+template<Random random_t = qss::random::mersenne::random_t<qss::random::philox::philox4x32>>
+class engine_t {
+    using idx_t = std::uint32_t;
+
+    // потоки живут всё время жизни движка, по указателю -- чтобы движок оставался перемещаемым
+    std::unique_ptr<qss::thread_team> team;
+    std::uint64_t seed;
+    std::uint32_t sweep = 0;
+    std::unique_ptr<std::atomic<idx_t>[]> parents{};
+    std::vector<std::uint8_t> flips{}; // переворачивается ли кластер узла
+    std::size_t amount = 0;
+
+    [[nodiscard]] idx_t find(idx_t idx) noexcept
+    {
+        while (true) {
+            auto parent = parents[idx].load();
+            if (parent == idx) {
+                return idx;
+            }
+            const auto grandparent = parents[parent].load();
+            if (parent != grandparent) {
+                parents[idx].compare_exchange_weak(parent, grandparent);
+            }
+            idx = grandparent;
+        }
+    }
+    void unite(idx_t lhs, idx_t rhs) noexcept
+    {
+        while (true) {
+            lhs = find(lhs);
+            rhs = find(rhs);
+            if (lhs == rhs) {
+                return;
+            }
+            // больший корень подвешивается к меньшему
+            if (lhs < rhs) {
+                std::swap(lhs, rhs);
+            }
+            auto expected = lhs;
+            if (parents[lhs].compare_exchange_strong(expected, rhs)) {
+                return;
+            }
+        }
+    }
+
+    /*
+     * проход по узлам [first; last) доли потока: перед каждым блоком
+     * генератор заменяется потоком (seed, блок, шаг, проход)
+     **/
+    template<typename func_t>
+    void for_each_with_stream(
+        const std::size_t thread_idx, const std::uint32_t pass, func_t&& func) const
+    {
+        random_t rand{};
+        const auto [first, last]
+            = qss::get_block_chunk(amount, stream_block_size, thread_idx, team->get_threads_amount());
+        for (auto idx = first; idx < last; ++idx) {
+            if (idx % stream_block_size == 0) {
+                rand = random_t{qss::random::philox::make_stream(
+                    seed, 0, static_cast<std::uint32_t>(idx), 2 * sweep + pass)};
+            }
+            func(idx, rand);
+        }
+    }
+
+public:
+    /*
+     * узлов на один случайный поток и наименьшая доля работы потока:
+     * мелкие блоки делят между потоками даже цвета плёнок в тысячу узлов
+     **/
+    static constexpr std::size_t stream_block_size = 64;
+
+    explicit engine_t(
+        const std::size_t threads_amount_ = qss::get_default_threads_amount(),
+        const std::uint64_t seed_ = qss::random::get_seed())
+        : team{std::make_unique<qss::thread_team>(threads_amount_)}
+        , seed{seed_}
+    {
+    }
+
+    [[nodiscard]] std::size_t get_threads_amount() const noexcept
+    {
+        return team->get_threads_amount();
+    }
+    // номер следующего шага, входит в ключ случайных потоков
+    [[nodiscard]] std::uint32_t get_sweep() const noexcept
+    {
+        return sweep;
+    }
+
+    /*
+     * один шаг Свендсена-Ванга по всей решётке
+     * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+     **/
+    template<typename lattice_t, std::size_t neighbours_amount>
+    std::pair<typename lattice_t::value_t::magn_t, double> make_step(
+        lattice_t& lattice,
+        const qss::lattices::neighbours_table_t<neighbours_amount>& neighbours_table,
+        double temperature,
+        double J = 1.0)
+    {
+        using value_t = typename lattice_t::value_t;
+        using table_t = qss::lattices::neighbours_table_t<neighbours_amount>;
+        static_assert(
+            std::is_same_v<value_t, qss::ising::spin>, "Swendsen-Wang update is for Ising spins");
+
+        if (amount != lattice.get_amount_of_nodes()) {
+            amount = lattice.get_amount_of_nodes();
+            parents = std::make_unique<std::atomic<idx_t>[]>(amount);
+            flips.assign(amount, 0);
+        }
+        const double p_add = 1.0 - std::exp(-2.0 * J / temperature);
+        const auto threads_amount = team->get_threads_amount();
+
+        team->run([&](const std::size_t thread_idx) {
+            const auto [first, last] = qss::get_chunk(amount, thread_idx, threads_amount);
+            for (auto idx = first; idx < last; ++idx) {
+                parents[idx].store(static_cast<idx_t>(idx));
+            }
+        });
+        // связи между одинаково направленными соседями
+        team->run([&](const std::size_t thread_idx) {
+            for_each_with_stream(thread_idx, 0, [&](const std::size_t idx, random_t& rand) {
+                const auto value = lattice.get_by_idx(idx).value;
+                for (const auto neig : neighbours_table[idx]) {
+                    if (neig == table_t::npos || neig <= idx) {
+                        continue;
+                    }
+                    if (lattice.get_by_idx(neig).value == value && rand() < p_add) {
+                        unite(static_cast<idx_t>(idx), neig);
+                    }
+                }
+            });
+        });
+        // случайный бит для каждого кластера
+        team->run([&](const std::size_t thread_idx) {
+            for_each_with_stream(thread_idx, 1, [&](const std::size_t idx, random_t& rand) {
+                if (parents[idx].load() == idx) {
+                    flips[idx] = static_cast<std::uint8_t>(rand(0, 2));
+                }
+            });
+        });
+        // признак переворота переносится с корня на все узлы кластера
+        team->run([&](const std::size_t thread_idx) {
+            const auto [first, last] = qss::get_chunk(amount, thread_idx, threads_amount);
+            for (auto idx = first; idx < last; ++idx) {
+                if (parents[idx].load() != idx) {
+                    flips[idx] = flips[find(static_cast<idx_t>(idx))];
+                }
+            }
+        });
+        // изменение энергии -- по связям между перевёрнутыми и неперевёрнутыми узлами
+        std::vector<std::pair<double, double>> deltas(threads_amount);
+        team->run([&](const std::size_t thread_idx) {
+            const auto [first, last] = qss::get_chunk(amount, thread_idx, threads_amount);
+            double delta_magn = 0.0;
+            double delta_energy = 0.0;
+            for (auto idx = first; idx < last; ++idx) {
+                const auto flip = flips[idx];
+                const auto value = lattice.get_by_idx(idx).value;
+                if (flip) {
+                    delta_magn -= 2.0 * value;
+                }
+                for (const auto neig : neighbours_table[idx]) {
+                    if (neig == table_t::npos || neig <= idx) {
+                        continue;
+                    }
+                    if (flip != flips[neig]) {
+                        delta_energy += 2.0 * J * value * lattice.get_by_idx(neig).value;
+                    }
+                }
+            }
+            deltas[thread_idx] = {delta_magn, delta_energy};
+        });
+        team->run([&](const std::size_t thread_idx) {
+            const auto [first, last] = qss::get_chunk(amount, thread_idx, threads_amount);
+            for (auto idx = first; idx < last; ++idx) {
+                if (flips[idx]) {
+                    const auto value = lattice.get_by_idx(idx).value;
+                    lattice.set_by_idx(value_t{static_cast<std::int8_t>(-value)}, idx);
+                }
+            }
+        });
+
+        ++sweep;
+
+        std::pair<double, double> result{};
+        for (const auto& [delta_magn, delta_energy] : deltas) {
+            result.first += delta_magn;
+            result.second += delta_energy;
+        }
+        return result;
+    }
+};
+} // namespace swendsen_wang
+} // namespace algorithms
+} // namespace qss
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef WOLFF_HPP_INCLUDED
+#define WOLFF_HPP_INCLUDED
+
+#include "../lattices/neighbours_table.hpp"
+#include "../models/ising.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/random.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qss {
+inline namespace algorithms {
+namespace wolff {
+/*
+ * кластерный алгоритм Вольфа для модели Изинга (J > 0).
+ * соседи берутся из таблицы, построенной с нужными граничными условиями, например
+ * make_neighbours_table(lattice, use_border_conditions<periodic, sharp>).
+ * буферы кластера хранятся в объекте и переиспользуются между вызовами
+ **/
+template<Random random_t = qss::random::mersenne::random_t<>>
+class engine_t {
+    using idx_t = std::uint32_t;
+
+    random_t rand;
+    std::vector<idx_t> cluster{};          // узлы кластера, он же очередь обхода
+    std::vector<std::uint8_t> in_cluster{}; // признак принадлежности узла кластеру
+
+public:
+    explicit engine_t(const std::size_t seed = qss::random::get_seed())
+        : rand{static_cast<unsigned int>(seed)}
+    {
+    }
+
+    [[nodiscard]] std::size_t get_last_cluster_size() const noexcept
+    {
+        return cluster.size();
+    }
+
+    /*
+     * строит и переворачивает один кластер
+     * возвращает std::pair{ изменение намагниченности (ненормированная), изменение энергии }
+     **/
+    template<typename lattice_t, std::size_t neighbours_amount>
+    std::pair<typename lattice_t::value_t::magn_t, double> make_step(
+        lattice_t& lattice,
+        const qss::lattices::neighbours_table_t<neighbours_amount>& neighbours_table,
+        double temperature,
+        double J = 1.0)
+    {
+        using value_t = typename lattice_t::value_t;
+        using table_t = qss::lattices::neighbours_table_t<neighbours_amount>;
+        static_assert(std::is_same_v<value_t, qss::ising::spin>, "Wolff update is for Ising spins");
+
+        const auto amount = lattice.get_amount_of_nodes();
+        if (in_cluster.size() != amount) {
+            in_cluster.assign(amount, 0);
+            cluster.reserve(amount);
+        }
+        cluster.clear();
+
+        const double p_add = 1.0 - std::exp(-2.0 * J / temperature);
+        const auto seed = static_cast<idx_t>(rand(0, static_cast<int>(amount)));
+        const auto value = lattice.get_by_idx(seed).value;
+        const value_t flipped{static_cast<std::int8_t>(-value)};
+
+        cluster.push_back(seed);
+        in_cluster[seed] = 1;
+        lattice.set_by_idx(flipped, seed);
+        for (std::size_t head = 0; head < cluster.size(); ++head) {
+            for (const auto neig : neighbours_table[cluster[head]]) {
+                if (neig == table_t::npos || in_cluster[neig]) {
+                    continue;
+                }
+                if (lattice.get_by_idx(neig).value == value && rand() < p_add) {
+                    in_cluster[neig] = 1;
+                    lattice.set_by_idx(flipped, neig);
+                    cluster.push_back(neig);
+                }
+            }
+        }
+
+        // энергия меняется только на связях, пересекающих границу кластера
+        double delta_energy = 0.0;
+        for (const auto idx : cluster) {
+            for (const auto neig : neighbours_table[idx]) {
+                if (neig != table_t::npos && !in_cluster[neig]) {
+                    delta_energy += 2.0 * J * value * lattice.get_by_idx(neig).value;
+                }
+            }
+        }
+        for (const auto idx : cluster) {
+            in_cluster[idx] = 0;
+        }
+
+        const auto delta_magn = -2.0 * value * static_cast<double>(cluster.size());
+        return std::pair{delta_magn, delta_energy};
+    }
+};
+} // namespace wolff
+} // namespace algorithms
+} // namespace qss
+
+#endif
@@ -0,0 +1,325 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../algorithms/Metropolis.hpp"
+#include "../algorithms/over_relaxation.hpp"
+#include "../algorithms/soa_metropolis.hpp"
+#include "../algorithms/spin_transport.hpp"
+#include "../lattices/2d/2d.hpp"
+#include "../lattices/2d/square.hpp"
+#include "../lattices/3d/3d.hpp"
+#include "../lattices/3d/fcc.hpp"
+#include "../lattices/borders_conditions.hpp"
+#include "../lattices/neighbours_table.hpp"
+#include "../lattices/soa_lattice.hpp"
+#include "../models/heisenberg.hpp"
+#include "../models/ising.hpp"
+#include "../random/random.hpp"
+#include "../systems/film.hpp"
+#include "../systems/multilayer.hpp"
+#include "../systems/multilayer_system.hpp"
+#include "../utility/functions.hpp"
+
+/*
+ * замеры производительности основных шагов:
+ * qss_bench [число шагов Монте-Карло = 10] [seed = 1]
+ * на выход -- таблица через табуляцию, по строке на замер:
+ * имя, размеры, число узлов, число шагов, нс на попытку переворота, попыток в секунду, байт на узел.
+ * попытка -- один выбранный узел (для spin_transport::engine_t -- одна попытка перескока,
+ * для переотражений -- одно отражение),
+ * байт на узел -- то, что шаг читает и пишет: спины и, если есть, таблица соседей
+ * (для переноса -- компонента спина и плотности up, down).
+ * в stderr -- набор инструкций soa_metropolis (avx512, avx2 или scalar, см. QSS_NATIVE)
+ **/
+namespace
+{
+    struct measurement_t
+    {
+        std::string name;
+        std::string sizes;
+        std::size_t nodes;
+        std::size_t steps;
+        double seconds;
+        double bytes_per_site;
+    };
+
+    void print_header()
+    {
+        std::cout << "benchmark\tsizes\tnodes\tsteps\tns_per_flip\tflips_per_s\tbytes_per_site\n";
+    }
+    void print(const measurement_t &data)
+    {
+        const double flips = static_cast<double>(data.nodes) * static_cast<double>(data.steps);
+        std::cout << data.name << "\t"
+                  << data.sizes << "\t"
+                  << data.nodes << "\t"
+                  << data.steps << "\t"
+                  << 1e9 * data.seconds / flips << "\t"
+                  << flips / data.seconds << "\t"
+                  << data.bytes_per_site << std::endl;
+    }
+
+    // один шаг на прогрев, затем {steps} замеряемых
+    template <typename step_f_t>
+    double measure(step_f_t step_f, const std::size_t steps)
+    {
+        step_f();
+        const auto begin = std::chrono::steady_clock::now();
+        for (std::size_t step = 0; step < steps; ++step)
+        {
+            step_f();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    std::string to_string(const qss::lattices::two_d::sizes_t &sizes)
+    {
+        return std::to_string(sizes.x) + "x" + std::to_string(sizes.y);
+    }
+    std::string to_string(const qss::lattices::three_d::sizes_t &sizes)
+    {
+        return std::to_string(sizes.x) + "x" + std::to_string(sizes.y) + "x" + std::to_string(sizes.z);
+    }
+
+    // суффикс имени замера, для случайного порядка (по умолчанию) -- пустой
+    std::string to_suffix(const qss::metropolis::sweep_order_t sweep_order)
+    {
+        switch (sweep_order)
+        {
+        case qss::metropolis::sweep_order_t::sequential:
+            return "_sequential";
+        case qss::metropolis::sweep_order_t::permutation:
+            return "_permutation";
+        default:
+            return "";
+        }
+    }
+    constexpr std::initializer_list<qss::metropolis::sweep_order_t> sweep_orders{
+        qss::metropolis::sweep_order_t::random,
+        qss::metropolis::sweep_order_t::sequential,
+        qss::metropolis::sweep_order_t::permutation};
+
+    void bench_square_ising(const std::size_t steps)
+    {
+        using spin_t = qss::ising::spin;
+        using lattice_t = qss::lattices::two_d::square<spin_t>;
+        using sizes_t = qss::lattices::two_d::sizes_t;
+        using conds = qss::borders_conditions::periodic<typename lattice_t::coords_t::size_type,
+                                                        typename sizes_t::size_type>;
+        constexpr double T = 2.269;
+        constexpr auto borders = qss::borders_conditions::use_border_conditions<conds, conds>;
+
+        for (const sizes_t::size_type L : std::initializer_list<sizes_t::size_type>{32, 64, 128, 256})
+        {
+            const sizes_t sizes{L, L};
+            {
+                lattice_t lattice{spin_t{1}, sizes};
+                auto delta_energy_f = [](const lattice_t &lattice_,
+                                         const lattice_t::coords_t &central,
+                                         const spin_t &new_spin) -> double
+                {
+                    const auto sum = qss::get_sum_of_closest_neighbours(lattice_, central, borders);
+                    return sum * (lattice_.get(central) - new_spin);
+                };
+                const double seconds = measure([&]()
+                                               { qss::metropolis::make_step(lattice, delta_energy_f, T); },
+                                               steps);
+                print({"metropolis_square_ising", to_string(sizes), lattice.get_amount_of_nodes(), steps,
+                       seconds, static_cast<double>(sizeof(spin_t))});
+            }
+            for (const auto sweep_order : sweep_orders)
+            {
+                lattice_t lattice{spin_t{1}, sizes};
+                const auto neighbours_table = qss::lattices::make_neighbours_table(lattice, borders);
+                auto delta_energy_f = [&neighbours_table](const lattice_t &lattice_,
+                                                          const lattice_t::idx_t central,
+                                                          const spin_t &new_spin) -> double
+                {
+                    const auto sum = qss::get_sum_of_closest_neighbours(lattice_, central, neighbours_table);
+                    return sum * (lattice_.get_by_idx(central) - new_spin);
+                };
+                const double seconds = measure([&]()
+                                               { qss::metropolis::make_step(lattice, delta_energy_f, T, sweep_order); },
+                                               steps);
+                print({"metropolis_square_ising_table" + to_suffix(sweep_order), to_string(sizes), lattice.get_amount_of_nodes(), steps,
+                       seconds,
+                       static_cast<double>(sizeof(spin_t) +
+                                           lattice_t::neighbours_amount * sizeof(decltype(neighbours_table)::idx_t))});
+            }
+        }
+    }
+
+    void bench_fcc_heisenberg(const std::size_t steps)
+    {
+        using spin_t = qss::heisenberg::spin;
+        using lattice_t = qss::lattices::three_d::fcc<spin_t>;
+        using film_t = qss::film<lattice_t>;
+        using sizes_t = qss::lattices::three_d::sizes_t;
+        constexpr double T = 1.0;
+        constexpr auto borders = qss::borders_conditions::use_border_conditions<
+            film_t::xy_border_condition,
+            film_t::xy_border_condition,
+            film_t::z_border_condition>;
+
+        for (const sizes_t::size_type L : std::initializer_list<sizes_t::size_type>{8, 16, 32, 64})
+        {
+            const sizes_t sizes{L, L, 3};
+            {
+                film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
+                auto delta_energy_f = [](const film_t &film_,
+                                         const film_t::coords_t &central,
+                                         const spin_t &new_spin) -> double
+                {
+                    const auto sum = qss::get_sum_of_closest_neighbours(film_, central, borders);
+                    return film_.J * scalar_multiply(sum, film_.get(central) - new_spin);
+                };
+                const double seconds = measure([&]()
+                                               { qss::metropolis::make_step(film, delta_energy_f, T); },
+                                               steps);
+                print({"metropolis_fcc_heisenberg", to_string(sizes), film.get_amount_of_nodes(), steps,
+                       seconds, static_cast<double>(sizeof(spin_t))});
+            }
+            for (const auto sweep_order : sweep_orders)
+            {
+                film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
+                const auto neighbours_table = qss::make_neighbours_table(film);
+                auto delta_energy_f = [&neighbours_table](const film_t &film_,
+                                                          const film_t::idx_t central,
+                                                          const spin_t &new_spin) -> double
+                {
+                    const auto sum = qss::get_sum_of_closest_neighbours(film_, central, neighbours_table);
+                    return film_.J * scalar_multiply(sum, film_.get_by_idx(central) - new_spin);
+                };
+                const double seconds = measure([&]()
+                                               { qss::metropolis::make_step(film, delta_energy_f, T, sweep_order); },
+                                               steps);
+                print({"metropolis_fcc_heisenberg_table" + to_suffix(sweep_order), to_string(sizes), film.get_amount_of_nodes(), steps,
+                       seconds,
+                       static_cast<double>(sizeof(spin_t) +
+                                           lattice_t::neighbours_amount * sizeof(decltype(neighbours_table)::idx_t))});
+            }
+            {
+                film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
+                const auto neighbours_table = qss::make_neighbours_table(film);
+                auto delta_energy_f = [&neighbours_table](const film_t &film_,
+                                                          const film_t::idx_t central,
+                                                          const spin_t &new_spin) -> double
+                {
+                    const auto sum = qss::get_sum_of_closest_neighbours(film_, central, neighbours_table);
+                    return film_.J * scalar_multiply(sum, film_.get_by_idx(central) - new_spin);
+                };
+                // ширина подбирается до замера, замеряется шаг с замороженной шириной
+                qss::metropolis::cone_proposal_t proposal{};
+                proposal.tune(20);
+                for (std::size_t sweep = 0; sweep < 20; ++sweep)
+                {
+                    qss::metropolis::make_step(film, delta_energy_f, T, qss::metropolis::sweep_order_t::random, proposal);
+                }
+                const double seconds = measure([&]()
+                                               { qss::metropolis::make_step(film, delta_energy_f, T,
+                                                                            qss::metropolis::sweep_order_t::random,
+                                                                            proposal); },
+                                               steps);
+                print({"metropolis_fcc_heisenberg_table_cone", to_string(sizes), film.get_amount_of_nodes(), steps,
+                       seconds,
+                       static_cast<double>(sizeof(spin_t) +
+                                           lattice_t::neighbours_amount * sizeof(decltype(neighbours_table)::idx_t))});
+            }
+            {
+                film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
+                const auto neighbours_table = qss::make_neighbours_table(film);
+                auto local_field_f = [&neighbours_table](const film_t &film_, const film_t::idx_t central)
+                {
+                    return film_.J * qss::get_sum_of_closest_neighbours(film_, central, neighbours_table);
+                };
+                const double seconds = measure([&]()
+                                               { qss::over_relaxation::make_step(film, local_field_f); },
+                                               steps);
+                print({"over_relaxation_fcc_heisenberg_table", to_string(sizes), film.get_amount_of_nodes(), steps,
+                       seconds,
+                       static_cast<double>(sizeof(spin_t) +
+                                           lattice_t::neighbours_amount * sizeof(decltype(neighbours_table)::idx_t))});
+            }
+            {
+                film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
+                const auto color_classes = qss::checkerboard::get_color_classes(film);
+                qss::lattices::soa_lattice<film_t> soa{film, qss::make_neighbours_table(film)};
+                const double seconds = measure([&]()
+                                               { qss::soa_metropolis::make_step(soa, color_classes, T, film.J); },
+                                               steps);
+                print({"soa_metropolis_fcc_heisenberg", to_string(sizes), film.get_amount_of_nodes(), steps,
+                       seconds,
+                       static_cast<double>(3 * sizeof(double) +
+                                           lattice_t::neighbours_amount * sizeof(decltype(soa)::idx_t))});
+            }
+        }
+    }
+
+    void bench_multilayer(const std::size_t steps)
+    {
+        using spin_t = qss::heisenberg::spin;
+        using lattice_t = qss::lattices::three_d::fcc<spin_t>;
+        using sizes_t = qss::lattices::three_d::sizes_t;
+        using qss::film;
+        using qss::multilayer;
+        using qss::multilayer_system;
+
+        auto delta_h = [](const spin_t::magn_t &sum, const spin_t &spin_old, const spin_t &spin_new) -> double
+        {
+            return scalar_multiply(sum, spin_old - spin_new);
+        };
+
+        for (const sizes_t::size_type L : std::initializer_list<sizes_t::size_type>{8, 16, 32, 64})
+        {
+            const sizes_t sizes{L, L, 3};
+            multilayer_system<multilayer<lattice_t>> system{
+                multilayer{{film<lattice_t>{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0},
+                            film<lattice_t>{lattice_t{spin_t{-1.0, 0.0, 0.0}, sizes}, 1.0}},
+                           {-0.3}}};
+            system.T = 0.67;
+            std::size_t nodes = 0;
+            for (const auto &film_ : system.nanostructure)
+            {
+                nodes += film_.get_amount_of_nodes();
+            }
+            {
+                const double seconds = measure([&]()
+                                               { system.evolve(delta_h); },
+                                               steps);
+                print({"multilayer_evolve", "2x" + to_string(sizes), nodes, steps,
+                       seconds, static_cast<double>(sizeof(spin_t))});
+            }
+            {
+                qss::spin_transport::engine_t transport{system, 'x'};
+                transport.fill(0, 0.5, 0.5);
+                transport.fill(1, 0.5, 0.5);
+                const double seconds = measure([&]()
+                                               { transport.perform(); },
+                                               steps);
+                print({"spin_transport_perform", "2x" + to_string(sizes), nodes, steps, seconds,
+                       static_cast<double>(3 * sizeof(double))});
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const std::size_t steps = argc > 1 ? std::stoul(argv[1]) : 10;
+    const std::size_t seed = argc > 2 ? std::stoul(argv[2]) : 1;
+    qss::random::fix_seed(seed);
+
+    std::cerr << "soa_metropolis: " << qss::soa_metropolis::instruction_set << "\n";
+    print_header();
+    bench_square_ising(steps);
+    bench_fcc_heisenberg(steps);
+    bench_multilayer(steps);
+
+    return 0;
+}
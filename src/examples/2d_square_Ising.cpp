@@ -1,28 +1,20 @@
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include "../algorithms/Metropolis.hpp"
+#include "../algorithms/checkerboard.hpp"
 #include "../models/ising.hpp"
 #include "../lattices/2d/square.hpp"
 #include "../lattices/2d/2d.hpp"
 #include "../lattices/borders_conditions.hpp"
+#include "../lattices/neighbours_table.hpp"
+#include "../utility/accumulators.hpp"
 #include "../utility/quantities.hpp"
 #include "../utility/functions.hpp"
-
-std::vector<double> get_temperatures(const double T_begin = 1.5,
-                                     const double T_end = 4.0,
-                                     const double delta_T = 0.25)
-{
-    std::vector<double> result{};
-    const auto T_amount = static_cast<int>((T_end - T_begin) / delta_T);
-    for (int i = 0; i < T_amount; ++i)
-    {
-        result.push_back(T_begin + i * delta_T);
-    }
-    return result;
-}
+#include "../utility/sweep.hpp"
 
 int main()
 {
@@ -36,39 +28,65 @@ int main()
     lattice_t lattice{spin_t{1}, sizes};
 
     constexpr static std::uint32_t mcs_amount = 2'000;
-    const std::vector temperatures = get_temperatures();
+    const std::vector temperatures = qss::get_temperatures(1.5, 3.75, 0.25);
 
+    const auto neighbours_table = qss::lattices::make_neighbours_table(
+        lattice,
+        qss::borders_conditions::use_border_conditions<conds, conds>);
+
+    auto delta_h = [](const spin_t::magn_t &sum,
+                      const spin_t &spin_old,
+                      const spin_t &spin_new) -> double
+    {
+        return sum * (spin_old - spin_new);
+    };
     auto delta_energy_f =
-        [](const lattice_t &lattice_,
-           const lattice_t::coords_t &central,
-           const spin_t &new_spin)
+        [&neighbours_table, &delta_h](const lattice_t &lattice_,
+                                      const lattice_t::idx_t central,
+                                      const spin_t &new_spin)
         -> double
     {
         const auto sum =
-            qss::get_sum_of_closest_neighbours(
-                lattice_,
-                central,
-                qss::borders_conditions::use_border_conditions<conds, conds>);
+            qss::get_sum_of_closest_neighbours(lattice_, central, neighbours_table);
 
-        return sum * (lattice_.get(central) - new_spin);
+        return delta_h(sum, lattice_.get_by_idx(central), new_spin);
     };
 
-    std::ofstream output{"m.txt"};
-    for (auto T : temperatures)
-    {
-        std::cout << "T = " << T << std::endl;
-        for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
+    const auto color_classes = qss::checkerboard::get_color_classes(lattice);
+
+    // температуры считаются параллельно, каждая со своей решёткой и в один поток.
+    // первая половина шагов -- термализация, по второй копятся моменты
+    const auto results = qss::run_sweep(
+        temperatures,
+        [](const double) { return lattice_t{spin_t{1}, sizes}; },
+        [&](lattice_t &lattice_, const double T)
         {
-            if (mcs % 100 == 0)
+            qss::checkerboard::engine_t engine{1};
+            qss::observables_accumulator_t accumulator{};
+            const auto amount = static_cast<double>(lattice_.get_amount_of_nodes());
+            double energy = qss::calculate_energy(lattice_, neighbours_table, delta_h, 1);
+            auto magn = qss::calculate_magn(lattice_);
+            for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
             {
-                using qss::ising::abs;
-                output << mcs << "\t"
-                       << T << "\t"
-                       << abs(qss::calculate_magn(lattice))
-                       << "\n";
+                if (mcs > mcs_amount / 2)
+                {
+                    accumulator.add(magn, energy);
+                }
+                const auto [dM, dE] = engine.make_step(lattice_, color_classes, delta_energy_f, T);
+                magn += dM / amount;
+                energy += dE / amount;
             }
-            qss::metropolis::make_step(lattice, delta_energy_f, T);
-        }
+            return accumulator.get_summary(T, lattice_.get_amount_of_nodes());
+        });
+
+    // T, затем поля observables_summary_t
+    std::ofstream output{"m.txt"};
+    for (std::size_t i = 0; i < temperatures.size(); ++i)
+    {
+        std::cout << "T = " << temperatures[i] << std::endl;
+        output << temperatures[i] << "\t"
+               << results[i]
+               << "\n";
     }
     output.flush();
     output.close();
@@ -1,77 +1,81 @@
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include "../algorithms/Metropolis.hpp"
+#include "../algorithms/checkerboard.hpp"
 #include "../models/heisenberg.hpp"
 #include "../lattices/3d/fcc.hpp"
 #include "../lattices/3d/3d.hpp"
 #include "../lattices/borders_conditions.hpp"
+#include "../lattices/neighbours_table.hpp"
+#include "../systems/film.hpp"
 #include "../utility/quantities.hpp"
 #include "../utility/functions.hpp"
-
-std::vector<double> get_temperatures(const double T_begin = 1.0,
-                                     const double T_end = 5.0,
-                                     const double delta_T = 0.25)
-{
-    std::vector<double> result{};
-    const auto T_amount = static_cast<int>((T_end - T_begin) / delta_T) + 1;
-    for (int i = 0; i < T_amount; ++i)
-    {
-        result.push_back(T_begin + i * delta_T);
-    }
-    return result;
-}
+#include "../utility/sweep.hpp"
 
 int main()
 {
     using spin_t = qss::heisenberg::spin;
     using lattice_t = qss::lattices::three_d::fcc<spin_t>;
+    using film_t = qss::film<lattice_t>;
     using sizes_t = qss::lattices::three_d::sizes_t;
-    using periodic = qss::borders_conditions::periodic<typename lattice_t::coords_t::size_type,
-                                                       typename sizes_t::size_type>;
-    using sharp = qss::borders_conditions::sharp<typename lattice_t::coords_t::size_type,
-                                                 typename sizes_t::size_type>;
 
     constexpr static sizes_t sizes{16, 16, 3};
-    lattice_t lattice{spin_t{1.0, 0.0, 0.0}, sizes};
+    film_t film{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0};
 
     constexpr static std::uint32_t mcs_amount = 5'000;
-    const std::vector temperatures = get_temperatures();
+    const std::vector temperatures = qss::get_temperatures(1.0, 5.0, 0.25);
+
+    // периодические граничные условия по XY и резкие по Z задаёт сама плёнка
+    const auto neighbours_table = qss::make_neighbours_table(film);
+    const auto color_classes = qss::checkerboard::get_color_classes(film);
 
     auto delta_energy_f =
-        [](const lattice_t &lattice_,
-           const lattice_t::coords_t &central,
-           const spin_t &new_spin)
+        [&neighbours_table](const film_t &film_,
+                            const film_t::idx_t central,
+                            const spin_t &new_spin)
         -> double
     {
         const auto sum =
-            qss::get_sum_of_closest_neighbours(
-                lattice_,
-                central,
-                qss::borders_conditions::use_border_conditions<periodic, periodic, sharp>);
+            qss::get_sum_of_closest_neighbours(film_, central, neighbours_table);
 
-        return scalar_multiply(sum, (lattice_.get(central) - new_spin));
+        return film_.J * scalar_multiply(sum, (film_.get_by_idx(central) - new_spin));
     };
 
-    std::ofstream output{"m.txt"};
-    for (auto T : temperatures)
-    {
-        std::cout << "T = " << T << std::endl;
-        for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
+    // температуры считаются параллельно, каждая со своей плёнкой и в один поток
+    const auto results = qss::run_sweep(
+        temperatures,
+        [](const double) { return film_t{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0}; },
+        [&](film_t &film_, const double T)
         {
-            if (mcs % 100 == 0)
+            qss::checkerboard::engine_t engine{1};
+            std::vector<std::pair<std::size_t, spin_t::magn_t>> magns{};
+            for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
             {
-                const auto magn = qss::calculate_magn(lattice);
-                const auto absl = abs(magn);
-                output << mcs << "\t"
-                       << T << "\t"
-                       << absl << "\t"
-                       << magn << "\t"
-                       << "\n";
+                if (mcs % 100 == 0)
+                {
+                    magns.emplace_back(mcs, qss::calculate_magn(film_));
+                }
+                engine.make_step(film_, color_classes, delta_energy_f, T);
             }
-            qss::metropolis::make_step(lattice, delta_energy_f, T);
+            return magns;
+        });
+
+    std::ofstream output{"m.txt"};
+    for (std::size_t i = 0; i < temperatures.size(); ++i)
+    {
+        std::cout << "T = " << temperatures[i] << std::endl;
+        for (const auto &[mcs, magn] : results[i])
+        {
+            const auto absl = abs(magn);
+            output << mcs << "\t"
+                   << temperatures[i] << "\t"
+                   << absl << "\t"
+                   << magn << "\t"
+                   << "\n";
         }
     }
     output.flush();
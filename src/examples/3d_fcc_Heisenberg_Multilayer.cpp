@@ -1,4 +1,3 @@
-#include <fstream>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -10,6 +9,7 @@
 #include "../lattices/borders_conditions.hpp"
 #include "../utility/quantities.hpp"
 #include "../utility/functions.hpp"
+#include "../utility/async_writer.hpp"
 #include "../systems/multilayer.hpp"
 #include "../systems/multilayer_system.hpp"
 
@@ -31,7 +31,10 @@ int main()
     constexpr static std::uint32_t mcs_amount = 2'000;
     constexpr static double Delta = 0.665;
     system.T = 0.5;
-    std::ofstream out_magn{"m.txt"};
+    // двоичный столбцовый ряд пишется в фоновом потоке, в текст переводит qss_timeseries_to_text
+    qss::async_timeseries_writer_t out_magn{
+        "m.qts",
+        {"mcs", "T", "m1x", "m1y", "m1z", "m2x", "m2y", "m2z", "e1", "e2"}};
     for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
     {
         if (mcs % 10 == 0)
@@ -48,14 +51,11 @@ int main()
         const auto magn1 = system.magns[0];
         const auto magn2 = system.magns[1];
 
-        out_magn << mcs << "\t"
-                 << abs(magn1) - abs(magn2) << "\t"
-                 << abs(magn1) << "\t"
-                 << magn1 << "\t"
-                 << abs(magn2) << "\t"
-                 << magn2 << std::endl;
+        out_magn.add({static_cast<double>(mcs), system.T,
+                      magn1.x, magn1.y, magn1.z,
+                      magn2.x, magn2.y, magn2.z,
+                      system.energies[0], system.energies[1]});
     }
-    out_magn.flush();
     out_magn.close();
     return 0;
 }
\ No newline at end of file
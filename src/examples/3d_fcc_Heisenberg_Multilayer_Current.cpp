@@ -1,4 +1,3 @@
-#include <fstream>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -8,12 +7,12 @@
 #include "../lattices/3d/3d.hpp"
 #include "../lattices/3d/fcc.hpp"
 #include "../lattices/borders_conditions.hpp"
-#include "../models/electron_dencity.hpp"
 #include "../models/heisenberg.hpp"
 #include "../systems/multilayer.hpp"
 #include "../systems/multilayer_system.hpp"
 #include "../utility/functions.hpp"
 #include "../utility/quantities.hpp"
+#include "../utility/async_writer.hpp"
 
 
 int main()
@@ -24,8 +23,6 @@ int main()
     using qss::film;
     using qss::multilayer;
     using qss::multilayer_system;
-    using ed_t = qss::electron_dencity;
-    using electron_dencity_t = qss::lattices::three_d::fcc<ed_t>;
 
     constexpr static sizes_t sizes{64, 64, 3};
     constexpr static double J2 = -0.3;
@@ -35,21 +32,18 @@ int main()
         multilayer{{film<lattice_t>{lattice_t{spin_t{1.0, 0.0, 0.0}, sizes}, 1.0},
                     film<lattice_t>{lattice_t{spin_t{-1.0, 0.0, 0.0}, sizes}, 1.0}},
                    {J2}}};
-    multilayer n_up{{film<electron_dencity_t>{electron_dencity_t{ed_t{0.0}, sizes}, 1.0},
-                     film<electron_dencity_t>{electron_dencity_t{ed_t{0.0}, sizes}, 1.0}},
-                    {J2}};
-    multilayer n_down{{film<electron_dencity_t>{electron_dencity_t{ed_t{0.0}, sizes}, 1.0},
-                       film<electron_dencity_t>{electron_dencity_t{ed_t{0.0}, sizes}, 1.0}},
-                      {J2}};
 
-    auto sys = qss::spin_transport::prepare_proxy_structure(system, n_up, n_down);
+    // электронные плотности хранит сам движок, знак задаёт x-компонента спинов системы
+    qss::spin_transport::engine_t transport{system, 'x'};
 
     constexpr static std::uint32_t mcs_amount = 3'000;
     constexpr static double Delta = 0.665;
     system.T = T_0;
-    sys.T = system.T;
-    std::ofstream out_magn{"m.txt"};
-    std::ofstream out_j{"j.txt"};
+    // двоичные столбцовые ряды пишутся в фоновых потоках, в текст переводит qss_timeseries_to_text
+    qss::async_timeseries_writer_t out_magn{
+        "m.qts",
+        {"mcs", "T", "m1x", "m1y", "m1z", "m2x", "m2y", "m2z", "e1", "e2"}};
+    qss::async_timeseries_writer_t out_j{"j.qts", {"mcs", "T", "j_up", "j_down"}};
     for (std::size_t mcs = 0; mcs <= mcs_amount; ++mcs)
     {
         if (mcs % 10 == 0)
@@ -64,19 +58,15 @@ int main()
             const auto temp_magn2 = -abs(system.magns[1]);
             if (mcs == 2000)
             {
-                n_up[0].fill(ed_t{0.5 * (1.0 + temp_magn1)});
-                n_up[1].fill(ed_t{0.5 * (1.0 + temp_magn1)});
-                n_down[0].fill(ed_t{0.5 * (1.0 - temp_magn2)});
-                n_down[1].fill(ed_t{0.5 * (1.0 - temp_magn2)});
+                transport.fill(0, 0.5 * (1.0 + temp_magn1), 0.5 * (1.0 - temp_magn2));
+                transport.fill(1, 0.5 * (1.0 + temp_magn1), 0.5 * (1.0 - temp_magn2));
                 system.T = T_s;
-                sys.T = system.T;
             }
-            n_up[0].fill_plane(0, ed_t{0.5 * (1.0 + temp_magn1)});
-            n_down[0].fill_plane(0, ed_t{0.5 * (1.0 - temp_magn2)});
-            const auto [j_up, j_down] = qss::spin_transport::perform(sys);
+            transport.fill_plane(0, 0, 0.5 * (1.0 + temp_magn1), 0.5 * (1.0 - temp_magn2));
+            const auto [j_up, j_down] = transport.perform();
             j_up_all += j_up / (sizes.x * sizes.y);
             j_down_all += j_down / (sizes.x * sizes.y);
-            out_j << mcs << "\t" << j_up_all << "\t" << j_down_all << std::endl;
+            out_j.add({static_cast<double>(mcs), system.T, j_up_all, j_down_all});
         }
 
         system.evolve([](const typename spin_t::magn_t &sum, const spin_t &spin_old, const spin_t &spin_new) -> double {
@@ -88,11 +78,11 @@ int main()
         const auto magn1 = system.magns[0];
         const auto magn2 = system.magns[1];
 
-        out_magn << mcs << "\t" << abs(magn1) - abs(magn2) << "\t" << abs(magn1) << "\t" << magn1 << "\t" << abs(magn2)
-                 << "\t" << magn2 << std::endl;
+        out_magn.add({static_cast<double>(mcs), system.T,
+                      magn1.x, magn1.y, magn1.z,
+                      magn2.x, magn2.y, magn2.z,
+                      system.energies[0], system.energies[1]});
     }
-    out_magn.flush();
-    out_j.flush();
     out_magn.close();
     out_j.close();
 
@@ -0,0 +1,139 @@
+#ifndef PACKED_SQUARE_HPP_INCLUDED
+#define PACKED_SQUARE_HPP_INCLUDED
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "2d.hpp"
+#include "square.hpp"
+#include "../../models/ising.hpp"
+
+namespace qss::lattices::two_d
+{
+    /*
+     * квадратная решётка спинов Изинга, упакованных по 64 в машинное слово (бит 1 -- спин +1).
+     * строка из sizes.x узлов занимает words_per_row = sizes.x / 64 слов,
+     * бит {b} слова {i} хранит узел x = b * words_per_row + i.
+     * при такой раскладке соседи по X всех 64 узлов слова лежат в соседних словах той же строки,
+     * что позволяет обновлять слово целиком (см. algorithms/multispin.hpp).
+     * граничные условия -- только периодические, sizes.x кратен 64, sizes.y чётен
+     **/
+    class packed_square
+    {
+    public:
+        using value_t = qss::ising::spin;
+        using coords_t = square_coords_t;
+        using sizes_t = two_d::sizes_t;
+        using word_t = std::uint64_t;
+        static constexpr std::size_t bits_per_word = 64;
+
+        const sizes_t sizes;
+
+    private:
+        std::size_t words_per_row;
+        std::vector<word_t> words;
+
+        void bounds_check(const coords_t &coords) const
+        {
+            if (coords.x < 0 || coords.x >= sizes.x)
+            {
+                throw std::out_of_range("coords.x out of range : " + std::to_string(coords.x));
+            }
+            if (coords.y < 0 || coords.y >= sizes.y)
+            {
+                throw std::out_of_range("coords.y out of range : " + std::to_string(coords.y));
+            }
+        }
+        [[nodiscard]] static sizes_t checked_sizes(const sizes_t &sizes_)
+        {
+            if (sizes_.x == 0 || sizes_.x % bits_per_word != 0)
+            {
+                throw std::logic_error("sizes.x must be a positive multiple of 64 : " + std::to_string(sizes_.x));
+            }
+            if (sizes_.y == 0 || sizes_.y % 2 != 0)
+            {
+                throw std::logic_error("sizes.y must be positive and even : " + std::to_string(sizes_.y));
+            }
+            return sizes_;
+        }
+
+    public:
+        packed_square(const value_t &initial_spin, const sizes_t &sizes_)
+            : sizes{checked_sizes(sizes_)},
+              words_per_row{sizes.x / bits_per_word},
+              words(words_per_row * sizes.y, initial_spin.value > 0 ? ~word_t{0} : word_t{0})
+        {
+        }
+        packed_square(const value_t &initial_spin,
+                      const typename sizes_t::size_type &size_x,
+                      const typename sizes_t::size_type &size_y)
+            : packed_square{initial_spin, sizes_t{size_x, size_y}} {}
+        explicit packed_square(const square<value_t> &lattice)
+            : packed_square{value_t{-1}, lattice.sizes}
+        {
+            for (std::size_t idx = 0; idx < lattice.get_amount_of_nodes(); ++idx)
+            {
+                set(lattice.get_by_idx(idx), lattice.get_coords(idx));
+            }
+        }
+
+        [[nodiscard]] std::size_t get_amount_of_nodes() const noexcept
+        {
+            return static_cast<std::size_t>(sizes.x) * sizes.y;
+        }
+        [[nodiscard]] std::size_t get_words_per_row() const noexcept
+        {
+            return words_per_row;
+        }
+        // слова строки {y}, без проверок
+        [[nodiscard]] word_t *get_row(const std::size_t y) noexcept
+        {
+            return words.data() + y * words_per_row;
+        }
+        [[nodiscard]] const word_t *get_row(const std::size_t y) const noexcept
+        {
+            return words.data() + y * words_per_row;
+        }
+
+        [[nodiscard]] value_t get(const coords_t &coords) const
+        {
+            bounds_check(coords);
+            const auto x = static_cast<std::size_t>(coords.x);
+            const auto word = get_row(static_cast<std::size_t>(coords.y))[x % words_per_row];
+            return value_t{static_cast<std::int8_t>((word >> (x / words_per_row)) & 1u ? 1 : -1)};
+        }
+        void set(const value_t &value, const coords_t &coords)
+        {
+            bounds_check(coords);
+            const auto x = static_cast<std::size_t>(coords.x);
+            auto &word = get_row(static_cast<std::size_t>(coords.y))[x % words_per_row];
+            const auto bit = word_t{1} << (x / words_per_row);
+            word = value.value > 0 ? (word | bit) : (word & ~bit);
+        }
+
+        // сумма спинов решётки
+        [[nodiscard]] long long get_sum() const noexcept
+        {
+            long long up = 0;
+            for (const auto word : words)
+            {
+                up += static_cast<long long>(std::bitset<bits_per_word>{word}.count());
+            }
+            return 2 * up - static_cast<long long>(get_amount_of_nodes());
+        }
+    };
+}
+
+namespace qss
+{
+    [[nodiscard]] inline double calculate_magn(const qss::lattices::two_d::packed_square &lattice) noexcept
+    {
+        return static_cast<double>(lattice.get_sum()) / static_cast<double>(lattice.get_amount_of_nodes());
+    }
+}
+
+#endif
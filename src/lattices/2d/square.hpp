@@ -1,6 +1,7 @@
 #ifndef SQUARE_HPP_INCLUDED
 #define SQUARE_HPP_INCLUDED
 
+#include <cstddef>
 #include <vector>
 #include <utility>
 #include <algorithm>
@@ -30,15 +31,19 @@ namespace qss::lattices::two_d
     }
 
     template <typename node_t> // TODO: добавить require для типа node_t
-    struct square : public base_lattice_t<node_t, square_coords_t>
+    struct square : public base_lattice_t<square<node_t>, node_t, square_coords_t>
     {
-        using base_t = base_lattice_t<node_t, square_coords_t>;
+        using base_t = base_lattice_t<square<node_t>, node_t, square_coords_t>;
         using typename base_t::coords_t;
         using typename base_t::value_t;
+        using typename base_t::idx_t;
         const two_d::sizes_t sizes;
         using sizes_t = two_d::sizes_t;
+        static constexpr std::size_t neighbours_amount = 4;
 
     private:
+        friend base_t;
+
         void bounds_check(const coords_t &coords) const
         {
             if (coords.x < 0 || coords.x >= sizes.x)
@@ -63,23 +68,27 @@ namespace qss::lattices::two_d
         constexpr explicit square(const sizes_t &sizes_)
             : square{value_t{}, sizes_.x, sizes_.y} {}
 
-        [[nodiscard]] value_t get(const coords_t &coords) const
+        // переход между координатами и номером узла в хранилище, без проверок
+        [[nodiscard]] idx_t get_idx(const coords_t &coords) const noexcept
         {
-            bounds_check(coords);
-            const auto idx = static_cast<typename base_t::size_type>(sizes.x * coords.y + coords.x);
-            return this->at(idx);
+            return static_cast<idx_t>(sizes.x * coords.y + coords.x);
         }
-        void set(const value_t &value, const coords_t &coords)
+        [[nodiscard]] coords_t get_coords(const idx_t idx) const noexcept
         {
-            bounds_check(coords);
-            const auto idx = static_cast<typename base_t::size_type>(sizes.x * coords.y + coords.x);
-            this->at(idx) = value;
+            return coords_t{static_cast<typename coords_t::size_type>(idx % sizes.x),
+                            static_cast<typename coords_t::size_type>(idx / sizes.x)};
         }
 
         template <typename random_t = qss::random::mersenne::random_t<>>
         [[nodiscard]] coords_t choose_random_node() const noexcept
         {
-            static auto rand = random_t{qss::random::get_seed()};
+            static thread_local auto rand = random_t{qss::random::get_seed()};
+            return choose_random_node(rand);
+        }
+        // для воспроизводимых алгоритмов: узел выбирается переданным генератором
+        template <typename random_t>
+        [[nodiscard]] coords_t choose_random_node(random_t &rand) const noexcept
+        {
             return coords_t{
                 static_cast<typename coords_t::size_type>(rand(0, sizes.x)),
                 static_cast<typename coords_t::size_type>(rand(0, sizes.y))};
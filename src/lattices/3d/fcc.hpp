@@ -1,6 +1,7 @@
 #ifndef FCC_HPP_INCLUDED
 #define FCC_HPP_INCLUDED
 
+#include <cstddef>
 #include <vector>
 #include <array>
 #include <stdexcept>
@@ -154,15 +155,19 @@ namespace qss::lattices::three_d
      * шаблонный параметр {node_t} -- тип хранимого узла (обычно просто спин нужной модели)
      **/
     template <typename node_t> // TODO: добавить require для типа node_t
-    struct face_centric_cubic : public base_lattice_t<node_t, fcc_coords_t>
+    struct face_centric_cubic : public base_lattice_t<face_centric_cubic<node_t>, node_t, fcc_coords_t>
     {
-        using base_t = base_lattice_t<node_t, fcc_coords_t>;
+        using base_t = base_lattice_t<face_centric_cubic<node_t>, node_t, fcc_coords_t>;
         using typename base_t::coords_t;
         using typename base_t::value_t;
+        using typename base_t::idx_t;
         const three_d::sizes_t sizes;
         using sizes_t = three_d::sizes_t;
+        static constexpr std::size_t neighbours_amount = 12;
 
     private:
+        friend base_t;
+
         void bounds_check(const coords_t &coords) const
         {
             if (coords.w >= 4)
@@ -190,18 +195,19 @@ namespace qss::lattices::three_d
         {
             return static_cast<typename base_t::size_type>(sublattice_size.x * sublattice_size.y * coords.z + sublattice_size.x * coords.y + coords.x);
         }
-        typename base_t::size_type calc_shift(const std::uint8_t &w) const
+        std::array<idx_t, 4> calc_shifts() const
         {
-            typename base_t::size_type result{};
-            for (auto i = 0u; i < w; ++i)
+            std::array<idx_t, 4> result{};
+            for (auto i = 1u; i < 4; ++i)
             {
-                result += get_amount_of_sublattice_nodes(sublattices_sizes[w]);
+                result[i] = result[i - 1] + get_amount_of_sublattice_nodes(sublattices_sizes[i - 1]);
             }
             return result;
         };
 
     public:
         const std::array<sizes_t, 4> sublattices_sizes; // размеры подрешёток
+        const std::array<idx_t, 4> sublattices_shifts;  // номер первого узла каждой подрешётки в хранилище
 
         constexpr face_centric_cubic(const value_t &initial_spin,
                                      const typename sizes_t::size_type &size_x,
@@ -223,7 +229,8 @@ namespace qss::lattices::three_d
                           static_cast<typename sizes_t::size_type>(size_z / 2)},
                   sizes_t{static_cast<typename sizes_t::size_type>(size_x / 2),
                           static_cast<typename sizes_t::size_type>(size_y / 2 + size_y % 2),
-                          static_cast<typename sizes_t::size_type>(size_z / 2)}}
+                          static_cast<typename sizes_t::size_type>(size_z / 2)}},
+              sublattices_shifts{calc_shifts()}
         {
         }
         constexpr face_centric_cubic(const value_t &initial_spin, const sizes_t &sizes_)
@@ -232,26 +239,43 @@ namespace qss::lattices::three_d
         constexpr face_centric_cubic(const sizes_t &sizes_)
             : face_centric_cubic{value_t{}, sizes_.x, sizes_.y, sizes_.z} {}
 
-        [[nodiscard]] value_t get(const coords_t &coords) const
+        // переход между координатами и номером узла в хранилище, без проверок.
+        // подрешётки хранятся подряд: сначала все узлы {w} = 0, затем {w} = 1 и т.д.
+        [[nodiscard]] idx_t get_idx(const coords_t &coords) const noexcept
         {
-            bounds_check(coords);
-            const typename base_t::size_type idx = calc_shift(coords.w) + calc_idx(sublattices_sizes[coords.w], coords);
-            assert(idx <= this->size());
-            return this->at(idx);
+            return sublattices_shifts[coords.w] + calc_idx(sublattices_sizes[coords.w], coords);
         }
-        void set(const value_t &value, const coords_t &coords)
+        [[nodiscard]] coords_t get_coords(idx_t idx) const noexcept
         {
-            bounds_check(coords);
-            const typename base_t::size_type idx = calc_shift(coords.w) + calc_idx(sublattices_sizes[coords.w], coords);
-            assert(idx <= this->size());
-            this->at(idx) = value;
+            using coord_size_t = typename coords_t::size_type;
+            std::uint8_t w = 0;
+            for (; w < 3; ++w)
+            {
+                const auto amount = get_amount_of_sublattice_nodes(sublattices_sizes[w]);
+                if (idx < amount)
+                {
+                    break;
+                }
+                idx -= amount;
+            }
+            const auto &sublattice_size = sublattices_sizes[w];
+            return coords_t{w,
+                            static_cast<coord_size_t>(idx % sublattice_size.x),
+                            static_cast<coord_size_t>((idx / sublattice_size.x) % sublattice_size.y),
+                            static_cast<coord_size_t>(idx / (sublattice_size.x * sublattice_size.y))};
         }
 
         template <typename random_t = qss::random::mersenne::random_t<>>
         [[nodiscard]] coords_t choose_random_node() const noexcept
+        {
+            static thread_local auto rand = random_t{qss::random::get_seed()};
+            return choose_random_node(rand);
+        }
+        // для воспроизводимых алгоритмов: узел выбирается переданным генератором
+        template <typename random_t>
+        [[nodiscard]] coords_t choose_random_node(random_t &rand) const noexcept
         {
             using coord_size_t = typename coords_t::size_type;
-            static auto rand = random_t{qss::random::get_seed()};
             const auto w = static_cast<std::uint8_t>(rand(0, 4));
             return coords_t{w, static_cast<coord_size_t>(rand(0, sublattices_sizes[w].x)),
                             static_cast<coord_size_t>(rand(0, sublattices_sizes[w].y)),
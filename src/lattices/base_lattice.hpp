@@ -2,6 +2,7 @@
 #define BASE_LATTICE_HPP_INCLUDED
 
 // #include <concepts>
+#include <cassert>
 #include <type_traits>
 #include <vector>
 
@@ -9,7 +10,15 @@
 
 namespace qss::lattices
 {
-    template <typename node_t, typename coordinates_t>
+    /*
+     * общая часть решёток, статический полиморфизм (CRTP): {derived_t} -- сама решётка,
+     * она задаёт get_idx(coords) и bounds_check(coords).
+     * get/set проверяют координаты и бросают std::out_of_range -- для пользовательского кода,
+     * get_unchecked/set_unchecked не проверяют ничего (кроме assert в отладочной сборке) --
+     * для ядер алгоритмов, где координаты заведомо внутри решётки
+     * (после граничных условий, из choose_random_node и т.п.)
+     **/
+    template <typename derived_t, typename node_t, typename coordinates_t>
     struct base_lattice_t : protected std::vector<node_t>
     {
         using container_t = std::vector<node_t>;
@@ -23,16 +32,27 @@ namespace qss::lattices
         using container_t::end;
         using container_t::rbegin;
         using container_t::rend;
+        using container_t::data; // хранилище узлов подряд, для двоичного сохранения
 
         // base_lattice_t(const base_lattice_t&) noexcept = default;
         // base_lattice_t(base_lattice_t&&) noexcept = default;
 
         using value_t = node_t;
         using coords_t = coordinates_t;
+        using idx_t = typename container_t::size_type; // номер узла в плоском хранилище
         [[nodiscard]] constexpr typename container_t::size_type get_amount_of_nodes() const noexcept
         {
             return this->size();
         }
+        // доступ по номеру узла, без проверок
+        [[nodiscard]] value_t get_by_idx(const idx_t idx) const noexcept
+        {
+            return (*this)[idx];
+        }
+        void set_by_idx(const value_t &value, const idx_t idx) noexcept
+        {
+            (*this)[idx] = value;
+        }
         constexpr void fill(const value_t &value) noexcept
         {
             for (auto &elem : *this)
@@ -41,12 +61,34 @@ namespace qss::lattices
             }
         }
 
-        virtual ~base_lattice_t() noexcept {};
-        [[nodiscard]] virtual value_t get(const coords_t &coord) const = 0;
-        virtual void set(const value_t &value, const coords_t &coords) = 0;
+        [[nodiscard]] value_t get(const coords_t &coords) const
+        {
+            get_derived().bounds_check(coords);
+            return (*this)[get_derived().get_idx(coords)];
+        }
+        void set(const value_t &value, const coords_t &coords)
+        {
+            get_derived().bounds_check(coords);
+            (*this)[get_derived().get_idx(coords)] = value;
+        }
+        [[nodiscard]] value_t get_unchecked(const coords_t &coords) const noexcept
+        {
+            const auto idx = get_derived().get_idx(coords);
+            assert(idx < this->size());
+            return (*this)[idx];
+        }
+        void set_unchecked(const value_t &value, const coords_t &coords) noexcept
+        {
+            const auto idx = get_derived().get_idx(coords);
+            assert(idx < this->size());
+            (*this)[idx] = value;
+        }
 
-    protected:
-        virtual void bounds_check(const coords_t &coords) const = 0;
+    private:
+        [[nodiscard]] const derived_t &get_derived() const noexcept
+        {
+            return static_cast<const derived_t &>(*this);
+        }
     };
 
     // template <typename T>
@@ -0,0 +1,83 @@
+#ifndef NEIGHBOURS_TABLE_HPP_INCLUDED
+#define NEIGHBOURS_TABLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace qss::lattices
+{
+    /*
+     * таблица ближайших соседей, строится один раз для решётки и граничных условий.
+     * для каждого узла (по номеру в хранилище решётки) хранит подряд
+     * {neighbours_amount} номеров соседей, отсутствующий сосед (резкая граница) -- {npos}
+     **/
+    template <std::size_t neighbours_amount_>
+    class neighbours_table_t
+    {
+    public:
+        using idx_t = std::uint32_t;
+        static constexpr idx_t npos = std::numeric_limits<idx_t>::max();
+        static constexpr std::size_t neighbours_amount = neighbours_amount_;
+
+        struct neighbours_t
+        {
+            const idx_t *first;
+            const idx_t *last;
+
+            [[nodiscard]] const idx_t *begin() const noexcept
+            {
+                return first;
+            }
+            [[nodiscard]] const idx_t *end() const noexcept
+            {
+                return last;
+            }
+        };
+
+        neighbours_table_t() noexcept = default;
+
+        template <typename lattice_t, typename borders_conditions_t>
+        neighbours_table_t(const lattice_t &lattice, borders_conditions_t borders_conditions)
+            : table(lattice.get_amount_of_nodes() * neighbours_amount, npos)
+        {
+            static_assert(lattice_t::neighbours_amount == neighbours_amount);
+            for (typename lattice_t::idx_t idx = 0; idx < lattice.get_amount_of_nodes(); ++idx)
+            {
+                const auto neigs = get_closest_neighbours(lattice.get_coords(idx));
+                auto *row = table.data() + idx * neighbours_amount;
+                for (std::size_t i = 0; i < neighbours_amount; ++i)
+                {
+                    const auto coord = borders_conditions(neigs[i], lattice.sizes);
+                    if (coord)
+                    {
+                        row[i] = static_cast<idx_t>(lattice.get_idx(coord.value()));
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] neighbours_t operator[](const std::size_t idx) const noexcept
+        {
+            const auto *row = table.data() + idx * neighbours_amount;
+            return {row, row + neighbours_amount};
+        }
+        [[nodiscard]] std::size_t get_amount_of_nodes() const noexcept
+        {
+            return table.size() / neighbours_amount;
+        }
+
+    private:
+        std::vector<idx_t> table{};
+    };
+
+    template <typename lattice_t, typename borders_conditions_t>
+    [[nodiscard]] neighbours_table_t<lattice_t::neighbours_amount>
+    make_neighbours_table(const lattice_t &lattice, borders_conditions_t borders_conditions)
+    {
+        return neighbours_table_t<lattice_t::neighbours_amount>{lattice, borders_conditions};
+    }
+}
+
+#endif
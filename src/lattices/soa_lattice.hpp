@@ -0,0 +1,127 @@
+#ifndef SOA_LATTICE_HPP_INCLUDED
+#define SOA_LATTICE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "neighbours_table.hpp"
+
+namespace qss::lattices
+{
+    /*
+     * хранилище гейзенберговских спинов решётки {lattice_t} в виде структуры массивов:
+     * отдельные массивы x, y, z по номеру узла.
+     * таблица соседей переложена по номеру соседа: neighbour(j, idx) = neighbours[j * amount + idx],
+     * так что номера j-х соседей подряд идущих узлов лежат подряд.
+     * отсутствующий сосед указывает на дополнительный нулевой узел с номером amount,
+     * поэтому сумма по соседям считается без ветвлений.
+     * геометрия (координаты, раскраска) берётся у исходной решётки, обмен -- load()/store()
+     **/
+    template <typename lattice_t>
+    class soa_lattice
+    {
+    public:
+        using value_t = typename lattice_t::value_t;
+        using idx_t = std::int32_t;
+        static constexpr std::size_t neighbours_amount = lattice_t::neighbours_amount;
+
+    private:
+        std::size_t amount;
+        std::vector<double> xs;
+        std::vector<double> ys;
+        std::vector<double> zs;
+        std::vector<idx_t> neighbours;
+
+    public:
+        soa_lattice(const lattice_t &lattice, const neighbours_table_t<neighbours_amount> &neighbours_table)
+            : amount{lattice.get_amount_of_nodes()},
+              xs(amount + 1, 0.0),
+              ys(amount + 1, 0.0),
+              zs(amount + 1, 0.0),
+              neighbours(amount * neighbours_amount)
+        {
+            if (neighbours_table.get_amount_of_nodes() != amount)
+            {
+                throw std::logic_error("neighbours table does not match lattice : " +
+                                       std::to_string(neighbours_table.get_amount_of_nodes()) +
+                                       " != " + std::to_string(amount));
+            }
+            using table_t = neighbours_table_t<neighbours_amount>;
+            for (std::size_t idx = 0; idx < amount; ++idx)
+            {
+                std::size_t j = 0;
+                for (const auto neig : neighbours_table[idx])
+                {
+                    neighbours[j * amount + idx] = static_cast<idx_t>(neig == table_t::npos ? amount : neig);
+                    ++j;
+                }
+            }
+            load(lattice);
+        }
+
+        void load(const lattice_t &lattice) noexcept
+        {
+            for (std::size_t idx = 0; idx < amount; ++idx)
+            {
+                set_by_idx(lattice.get_by_idx(idx), idx);
+            }
+        }
+        void store(lattice_t &lattice) const noexcept
+        {
+            for (std::size_t idx = 0; idx < amount; ++idx)
+            {
+                lattice.set_by_idx(get_by_idx(idx), idx);
+            }
+        }
+
+        [[nodiscard]] std::size_t get_amount_of_nodes() const noexcept
+        {
+            return amount;
+        }
+        [[nodiscard]] value_t get_by_idx(const std::size_t idx) const noexcept
+        {
+            return value_t{xs[idx], ys[idx], zs[idx]};
+        }
+        void set_by_idx(const value_t &value, const std::size_t idx) noexcept
+        {
+            xs[idx] = value.x;
+            ys[idx] = value.y;
+            zs[idx] = value.z;
+        }
+
+        [[nodiscard]] double *get_xs() noexcept
+        {
+            return xs.data();
+        }
+        [[nodiscard]] double *get_ys() noexcept
+        {
+            return ys.data();
+        }
+        [[nodiscard]] double *get_zs() noexcept
+        {
+            return zs.data();
+        }
+        // номера j-х соседей всех узлов
+        [[nodiscard]] const idx_t *get_neighbours(const std::size_t j) const noexcept
+        {
+            return neighbours.data() + j * amount;
+        }
+
+        [[nodiscard]] typename value_t::magn_t calculate_magn() const noexcept
+        {
+            typename value_t::magn_t result{};
+            for (std::size_t idx = 0; idx < amount; ++idx)
+            {
+                result.x += xs[idx];
+                result.y += ys[idx];
+                result.z += zs[idx];
+            }
+            return result / static_cast<double>(amount);
+        }
+    };
+}
+
+#endif
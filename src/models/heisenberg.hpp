@@ -4,6 +4,7 @@
 #include "../random/mersenne.hpp"
 #include "../random/random.hpp"
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -55,18 +56,60 @@ struct spin {
     template<Random random_t = qss::random::mersenne::random_t<>>
     static spin generate() noexcept
     {
-        static random_t rand{qss::random::get_seed()};
-        const double phi = rand.get_angle_2pi();
-        const double eta = rand.get_angle_pi();
-        const double sinus_eta = std::sin(eta / 2);
+        static thread_local random_t rand{qss::random::get_seed()};
+        return generate(rand);
+    }
+    /*
+     * для параллельных алгоритмов: каждый поток передаёт свой генератор.
+     * равномерно по сфере без тригонометрии (Марсалья):
+     * точка (u, v) равномерно в единичном круге, s = u^2 + v^2,
+     * тогда z = 1 - 2s, а (x, y) = 2 sqrt(1 - s) (u, v)
+     **/
+    template<Random random_t>
+    static spin generate(random_t& rand) noexcept
+    {
+        return generate_near(spin{0.0, 0.0, 1.0}, 2.0, rand);
+    }
+    /*
+     * равномерно по сферическому сегменту вокруг {center}: cos угла с {center} не меньше 1 - {width},
+     * width из (0; 2], при width = 2 -- вся сфера.
+     * предложение симметрично (вероятность перейти из a в b равна вероятности из b в a),
+     * поэтому годится для Метрополиса без поправок
+     **/
+    template<Random random_t>
+    static spin generate_near(const spin& center, const double width, random_t& rand) noexcept
+    {
+        double u = 0.0;
+        double v = 0.0;
+        double s = 0.0;
+        do {
+            u = rand(-1.0, 1.0);
+            v = rand(-1.0, 1.0);
+            s = u * u + v * v;
+        } while (s >= 1.0 || s == 0.0);
+        // s равномерно в (0; 1), (u, v) / sqrt(s) -- равномерное направление
+        const double cos_theta = 1.0 - width * s;
+        const double scale = std::sqrt(width * (2.0 - width * s));
+        const double a = u * scale;
+        const double b = v * scale;
 
-        spin result{};
-        result.x = sinus_eta * std::cos(phi / 2);
-        result.y = sinus_eta * std::sin(phi / 2);
-        result.z = std::cos(eta / 2);
+        // ортонормированный базис (t1, t2, center) без ветвлений по малым компонентам
+        // (Duff et al., "Building an Orthonormal Basis, Revisited")
+        const double sign = std::copysign(1.0, center.z);
+        const double p = -1.0 / (sign + center.z);
+        const double q = center.x * center.y * p;
 
+        spin result{};
+        result.x = a * (1.0 + sign * center.x * center.x * p) + b * q + cos_theta * center.x;
+        result.y = a * sign * q + b * (sign + center.y * center.y * p) + cos_theta * center.y;
+        result.z = -a * sign * center.x - b * center.y + cos_theta * center.z;
         return result;
     }
+    // нулевой вектор: delta_h(h, s, zero()) даёт энергию спина s в поле h
+    static constexpr spin zero() noexcept
+    {
+        return spin{0.0, 0.0, 0.0};
+    }
 
     operator magn_t() const noexcept
     {
@@ -202,6 +245,20 @@ inline double abs(magn&& val) noexcept
 {
     return std::sqrt(val.x * val.x + val.y * val.y + val.z * val.z);
 }
+/*
+ * отражение спина относительно направления поля {field}: 2 (s . h) h / |h|^2 - s.
+ * проекция на поле и длина спина сохраняются, а с ними и энергия -(h . s).
+ * при нулевом поле спин не меняется
+ **/
+inline spin reflect(const spin& value, const magn& field) noexcept
+{
+    const double field_square = scalar_multiply(field, field);
+    if (field_square == 0.0) {
+        return value;
+    }
+    const double factor = 2.0 * (field.x * value.x + field.y * value.y + field.z * value.z) / field_square;
+    return spin{factor * field.x - value.x, factor * field.y - value.y, factor * field.z - value.z};
+}
 inline double cos_of_angle(const magn& fst, const magn& snd) noexcept 
 {
     return scalar_multiply(fst, snd) / (abs(fst) * abs(snd));
@@ -3,6 +3,7 @@
 
 #include "../random/mersenne.hpp"
 #include "../random/random.hpp"
+#include "spin.hpp"
 
 #include <cmath>
 #include <cstdint>
@@ -20,13 +21,24 @@ struct spin {
     template<Random random_t = qss::random::mersenne::random_t<>>
     static spin generate() noexcept
     {
-        static random_t rand{qss::random::get_seed()};
+        static thread_local random_t rand{qss::random::get_seed()};
+        return generate(rand);
+    }
+    // для параллельных алгоритмов: каждый поток передаёт свой генератор
+    template<Random random_t>
+    static spin generate(random_t& rand) noexcept
+    {
         auto number = rand(0, 2);
         if (number == 0) {
             number = -1;
         }
         return spin{static_cast<std::int8_t>(number)};
     }
+    // нулевое значение: delta_h(h, s, zero()) даёт энергию спина s в поле h
+    static constexpr spin zero() noexcept
+    {
+        return spin{0};
+    }
 
     operator magn() const noexcept
     {
@@ -96,5 +108,12 @@ inline double abs(const magn& val) noexcept
 }
 } // namespace ising
 } // namespace models
+
+// изменение энергии 2 * s * (сумма соседей): до 2 * 12 для ГЦК, с запасом под слоистые структуры
+template<>
+struct energy_spectrum_traits<qss::ising::spin> {
+    static constexpr bool is_discrete = true;
+    static constexpr int max_delta_energy = 64;
+};
 } // namespace qss
 #endif
\ No newline at end of file
@@ -12,5 +12,19 @@ namespace qss
     // concept Spin = requires(T a, T b) {
     //     { T::generate() } -> std::convertible_to<T>;
     // };
+
+    /*
+     * свойства спектра изменения энергии модели.
+     * is_discrete -- при единичных обменных интегралах изменение энергии при смене спина целое,
+     * max_delta_energy -- наибольшее такое изменение, для которого стоит хранить таблицу
+     **/
+    template <typename spin_t>
+    struct energy_spectrum_traits
+    {
+        static constexpr bool is_discrete = false;
+        static constexpr int max_delta_energy = 0;
+    };
+    template <typename spin_t>
+    inline constexpr bool has_discrete_energy_v = energy_spectrum_traits<spin_t>::is_discrete;
 }
 #endif
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include <cmath>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <chrono>
 
@@ -26,6 +29,8 @@ namespace qss::random::mersenne
         [[nodiscard]] random_t(random_t<genrand_t> &&) noexcept = default;
 
         [[nodiscard]] random_t(const typename genrand_t::result_type seed) noexcept : m_genrand(seed) {}
+        //из готового генератора, например независимого потока philox::make_stream
+        [[nodiscard]] explicit random_t(const genrand_t &genrand) noexcept : m_genrand(genrand) {}
 
         ~random_t() noexcept = default;
 
@@ -37,6 +42,27 @@ namespace qss::random::mersenne
             this->m_genrand
                 .seed(static_cast<typename genrand_t::result_type>(seed));
         }
+        //состояние генератора в текстовом виде (operator<< генератора), для сохранения и восстановления
+        std::string get_state() const
+        {
+            std::ostringstream out{};
+            out << m_genrand;
+            return out.str();
+        }
+        void set_state(const std::string &state)
+        {
+            std::istringstream in{state};
+            in >> m_genrand;
+            if (!in)
+            {
+                throw std::invalid_argument("wrong random generator state");
+            }
+        }
+        //возвращает очередное значение генератора как есть (случайные биты)
+        typename genrand_t::result_type get_bits() noexcept
+        {
+            return m_genrand();
+        }
         //возвращает double в полуинтервале [0;1)
         double operator()() noexcept
         {
@@ -0,0 +1,171 @@
+#ifndef PHILOX_HPP_INCLUDED
+#define PHILOX_HPP_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace qss::random::philox
+{
+    /*
+     * счётчиковый генератор Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+     * очередной блок из 4 чисел -- биекция (ключ, счётчик), поэтому независимые воспроизводимые
+     * потоки получаются просто выбором ключа и старших слов счётчика, без общего состояния.
+     * удовлетворяет UniformRandomBitGenerator и подставляется в random_t как genrand_t
+     **/
+    class philox4x32
+    {
+    public:
+        using result_type = std::uint32_t;
+        using counter_t = std::array<std::uint32_t, 4>;
+        using key_t = std::array<std::uint32_t, 2>;
+
+    private:
+        static constexpr std::uint32_t multiplier_0 = 0xD251'1F53u;
+        static constexpr std::uint32_t multiplier_1 = 0xCD9E'8D57u;
+        static constexpr std::uint32_t weyl_0 = 0x9E37'79B9u;
+        static constexpr std::uint32_t weyl_1 = 0xBB67'AE85u;
+        static constexpr int rounds = 10;
+
+        key_t m_key{};
+        counter_t m_counter{};
+        counter_t m_block{};
+        unsigned m_position = 4; // сколько чисел блока уже выдано
+
+        void next_block() noexcept
+        {
+            m_block = generate(m_counter, m_key);
+            // младшее слово -- номер блока в потоке, остальные задают поток
+            if (++m_counter[0] == 0)
+            {
+                ++m_counter[1];
+            }
+            m_position = 0;
+        }
+
+    public:
+        static constexpr result_type min() noexcept
+        {
+            return std::numeric_limits<result_type>::min();
+        }
+        static constexpr result_type max() noexcept
+        {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        philox4x32() noexcept = default;
+        explicit philox4x32(const result_type seed) noexcept
+            : m_key{seed, 0}
+        {
+        }
+        philox4x32(const key_t &key, const counter_t &counter) noexcept
+            : m_key{key},
+              m_counter{counter}
+        {
+        }
+
+        void seed(const result_type seed) noexcept
+        {
+            *this = philox4x32{seed};
+        }
+
+        result_type operator()() noexcept
+        {
+            if (m_position == 4)
+            {
+                next_block();
+            }
+            return m_block[m_position++];
+        }
+        void discard(unsigned long long amount) noexcept
+        {
+            for (; amount > 0; --amount)
+            {
+                (*this)();
+            }
+        }
+
+        // сам блок: 10 раундов над счётчиком с ключом
+        [[nodiscard]] static counter_t generate(counter_t counter, key_t key) noexcept
+        {
+            for (int round = 0; round < rounds; ++round)
+            {
+                const std::uint64_t product_0 = std::uint64_t{multiplier_0} * counter[0];
+                const std::uint64_t product_1 = std::uint64_t{multiplier_1} * counter[2];
+                counter = {static_cast<std::uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+                           static_cast<std::uint32_t>(product_1),
+                           static_cast<std::uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+                           static_cast<std::uint32_t>(product_0)};
+                key[0] += weyl_0;
+                key[1] += weyl_1;
+            }
+            return counter;
+        }
+
+        friend bool operator==(const philox4x32 &lhs, const philox4x32 &rhs) noexcept
+        {
+            return lhs.m_key == rhs.m_key && lhs.m_counter == rhs.m_counter &&
+                   lhs.m_position == rhs.m_position;
+        }
+        friend bool operator!=(const philox4x32 &lhs, const philox4x32 &rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+        // состояние через пробел: ключ, счётчик, текущий блок, позиция в нём
+        friend std::ostream &operator<<(std::ostream &out, const philox4x32 &data)
+        {
+            out << data.m_key[0] << ' ' << data.m_key[1];
+            for (const auto word : data.m_counter)
+            {
+                out << ' ' << word;
+            }
+            for (const auto word : data.m_block)
+            {
+                out << ' ' << word;
+            }
+            out << ' ' << data.m_position;
+            return out;
+        }
+        friend std::istream &operator>>(std::istream &in, philox4x32 &data)
+        {
+            philox4x32 result{};
+            in >> result.m_key[0] >> result.m_key[1];
+            for (auto &word : result.m_counter)
+            {
+                in >> word;
+            }
+            for (auto &word : result.m_block)
+            {
+                in >> word;
+            }
+            in >> result.m_position;
+            if (in && result.m_position <= 4)
+            {
+                data = result;
+            }
+            else
+            {
+                in.setstate(std::ios::failbit);
+            }
+            return in;
+        }
+    };
+
+    /*
+     * независимый поток, однозначно задаваемый (сид запуска, поток, узел, шаг)
+     * одинаковые аргументы всегда дают одну и ту же последовательность
+     **/
+    [[nodiscard]] inline philox4x32 make_stream(const std::uint64_t run_seed,
+                                                const std::uint32_t thread,
+                                                const std::uint32_t site,
+                                                const std::uint32_t sweep) noexcept
+    {
+        return philox4x32{{static_cast<std::uint32_t>(run_seed), static_cast<std::uint32_t>(run_seed >> 32)},
+                          {0, site, sweep, thread}};
+    }
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define RANDOM_HPP_INCLUDED
 
 // #include <concepts>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <optional>
 #include <stdexcept>
 
 #define Random typename // to migrate to c++17
@@ -21,9 +23,29 @@ namespace qss
 
     namespace random 
     {
+        namespace detail
+        {
+            inline std::optional<std::size_t> &get_fixed_seed() noexcept
+            {
+                static std::optional<std::size_t> seed{};
+                return seed;
+            }
+        }
+
+        /*
+         * фиксирует сид запуска: дальше get_seed() вместо времени использует {run_seed},
+         * и последовательность выдаваемых сидов (а с ней и все генераторы) воспроизводима.
+         * вызывать до первого обращения к генераторам, статические генераторы сидируются один раз
+         **/
+        inline void fix_seed(const std::size_t run_seed) noexcept
+        {
+            detail::get_fixed_seed() = run_seed;
+        }
+
         inline std::size_t get_seed(const std::size_t init = 0, const std::size_t top_limiter = 2'004'991) noexcept
         {
-            static std::size_t counter = 0;
+            // генераторы могут сидироваться из разных потоков
+            static std::atomic<std::size_t> counter{0};
 
             using std::chrono::nanoseconds;
             using clock_type = std::chrono::system_clock;
@@ -35,14 +57,9 @@ namespace qss
             const auto time_interval =
                 static_cast<std::size_t>(std::chrono::duration_cast<nanoseconds>(time_end - time_start).count());
 
-            const auto seed = (time_interval + counter) % top_limiter;
-
-            counter += init + 1;
-
-            if (counter > top_limiter)
-            {
-                counter -= top_limiter;
-            }
+            const auto &fixed_seed = detail::get_fixed_seed();
+            const auto current = counter.fetch_add(init + 1) % top_limiter;
+            const auto seed = ((fixed_seed ? *fixed_seed : time_interval) + current) % top_limiter;
 
             return seed;
         }
@@ -0,0 +1,448 @@
+#ifndef CHECKPOINT_HPP_INCLUDED
+#define CHECKPOINT_HPP_INCLUDED
+
+#include "film.hpp"
+#include "multilayer.hpp"
+#include "multilayer_system.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define QSS_CHECKPOINT_MMAP
+#endif
+
+namespace qss {
+namespace checkpoint {
+/*
+ * двоичные контрольные точки: решётки, плёнки, многослойные структуры и multilayer_system.
+ * формат: заголовок {magic, version, kind}, затем поля подряд в порядке записи,
+ * числа -- в представлении машины, узлы решётки -- одним блоком байт хранилища.
+ * файл читается через отображение в память (mmap), узлы копируются в решётку одним memcpy
+ **/
+inline constexpr char magic[8] = {'Q', 'S', 'S', 'C', 'K', 'P', 'T', '\0'};
+inline constexpr std::uint32_t version = 4;
+
+enum class kind_t : std::uint32_t {
+    lattice = 1,
+    film = 2,
+    multilayer = 3,
+    multilayer_system = 4,
+};
+
+namespace detail {
+class writer_t {
+    std::ofstream out;
+    std::string path;
+
+public:
+    writer_t(const std::string& path_, const kind_t kind)
+        : out{path_, std::ios::binary | std::ios::trunc}
+        , path{path_}
+    {
+        if (!out) {
+            throw std::runtime_error("cannot open checkpoint for writing : " + path);
+        }
+        write_bytes(magic, sizeof(magic));
+        write(version);
+        write(kind);
+    }
+    ~writer_t() noexcept = default;
+
+    void write_bytes(const void* data, const std::size_t size)
+    {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!out) {
+            throw std::runtime_error("cannot write checkpoint : " + path);
+        }
+    }
+    template<typename value_t>
+    void write(const value_t& value)
+    {
+        static_assert(std::is_trivially_copyable_v<value_t>);
+        write_bytes(&value, sizeof(value_t));
+    }
+    template<typename value_t>
+    void write_vector(const std::vector<value_t>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<value_t>);
+        write(static_cast<std::uint64_t>(values.size()));
+        write_bytes(values.data(), values.size() * sizeof(value_t));
+    }
+    void write_string(const std::string& value)
+    {
+        write(static_cast<std::uint64_t>(value.size()));
+        write_bytes(value.data(), value.size());
+    }
+    void close()
+    {
+        out.close();
+        if (!out) {
+            throw std::runtime_error("cannot write checkpoint : " + path);
+        }
+    }
+};
+
+// файл, отображённый в память только для чтения (или прочитанный целиком без mmap)
+class mapped_file_t {
+    const std::byte* data = nullptr;
+    std::size_t size = 0;
+#if defined(QSS_CHECKPOINT_MMAP)
+    void* mapping = nullptr;
+#else
+    std::vector<std::byte> buffer{};
+#endif
+
+public:
+    explicit mapped_file_t(const std::string& path)
+    {
+#if defined(QSS_CHECKPOINT_MMAP)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open checkpoint : " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat checkpoint : " + path);
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        if (size != 0) {
+            mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::runtime_error("cannot map checkpoint : " + path);
+        }
+        if (mapping != nullptr) {
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+        }
+        data = static_cast<const std::byte*>(mapping);
+#else
+        std::ifstream in{path, std::ios::binary | std::ios::ate};
+        if (!in) {
+            throw std::runtime_error("cannot open checkpoint : " + path);
+        }
+        size = static_cast<std::size_t>(in.tellg());
+        buffer.resize(size);
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+        if (!in) {
+            throw std::runtime_error("cannot read checkpoint : " + path);
+        }
+        data = buffer.data();
+#endif
+    }
+    mapped_file_t(const mapped_file_t&) = delete;
+    mapped_file_t& operator=(const mapped_file_t&) = delete;
+    ~mapped_file_t() noexcept
+    {
+#if defined(QSS_CHECKPOINT_MMAP)
+        if (mapping != nullptr) {
+            ::munmap(mapping, size);
+        }
+#endif
+    }
+
+    [[nodiscard]] const std::byte* get_data() const noexcept
+    {
+        return data;
+    }
+    [[nodiscard]] std::size_t get_size() const noexcept
+    {
+        return size;
+    }
+};
+
+class reader_t {
+    mapped_file_t file;
+    std::size_t position = 0;
+
+public:
+    reader_t(const std::string& path, const kind_t kind)
+        : file{path}
+    {
+        char magic_[sizeof(magic)]{};
+        read_bytes(magic_, sizeof(magic));
+        if (std::memcmp(magic_, magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("not a checkpoint : " + path);
+        }
+        const auto version_ = read<std::uint32_t>();
+        if (version_ != version) {
+            throw std::runtime_error(
+                "unsupported checkpoint version : " + std::to_string(version_)
+                + " != " + std::to_string(version));
+        }
+        const auto kind_ = read<kind_t>();
+        if (kind_ != kind) {
+            throw std::runtime_error(
+                "checkpoint kind mismatch : " + std::to_string(static_cast<std::uint32_t>(kind_))
+                + " != " + std::to_string(static_cast<std::uint32_t>(kind)));
+        }
+    }
+
+    // сколько байт файла ещё не прочитано
+    [[nodiscard]] std::size_t get_remaining() const noexcept
+    {
+        return file.get_size() - position;
+    }
+    /*
+     * число записей, прочитанное из файла, перед выделением памяти под них:
+     * каждая запись занимает не меньше {min_record_size} байт, иначе файл испорчен
+     **/
+    [[nodiscard]] std::size_t read_amount(const std::size_t min_record_size)
+    {
+        const auto amount = read<std::uint64_t>();
+        if (amount > get_remaining() / min_record_size) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        return static_cast<std::size_t>(amount);
+    }
+
+    void read_bytes(void* data, const std::size_t size)
+    {
+        if (size > file.get_size() - position) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        if (size != 0) {
+            std::memcpy(data, file.get_data() + position, size);
+        }
+        position += size;
+    }
+    template<typename value_t>
+    [[nodiscard]] value_t read()
+    {
+        static_assert(std::is_trivially_copyable_v<value_t>);
+        value_t result{};
+        read_bytes(&result, sizeof(value_t));
+        return result;
+    }
+    template<typename value_t>
+    [[nodiscard]] std::vector<value_t> read_vector()
+    {
+        static_assert(std::is_trivially_copyable_v<value_t>);
+        const auto size = static_cast<std::size_t>(read<std::uint64_t>());
+        if (size > (file.get_size() - position) / sizeof(value_t)) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        std::vector<value_t> result(size);
+        read_bytes(result.data(), size * sizeof(value_t));
+        return result;
+    }
+    [[nodiscard]] std::string read_string()
+    {
+        const auto size = static_cast<std::size_t>(read<std::uint64_t>());
+        if (size > file.get_size() - position) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        std::string result(size, '\0');
+        read_bytes(result.data(), size);
+        return result;
+    }
+};
+
+template<typename lattice_t>
+void write_lattice(writer_t& writer, const lattice_t& lattice)
+{
+    using value_t = typename lattice_t::value_t;
+    static_assert(std::is_trivially_copyable_v<value_t>, "nodes are saved as raw bytes");
+    writer.write(static_cast<std::uint64_t>(sizeof(value_t)));
+    writer.write(lattice.sizes);
+    writer.write(static_cast<std::uint64_t>(lattice.get_amount_of_nodes()));
+    writer.write_bytes(lattice.data(), lattice.get_amount_of_nodes() * sizeof(value_t));
+}
+
+template<typename lattice_t>
+[[nodiscard]] lattice_t read_lattice(reader_t& reader)
+{
+    using value_t = typename lattice_t::value_t;
+    static_assert(std::is_trivially_copyable_v<value_t>, "nodes are saved as raw bytes");
+    const auto value_size = reader.read<std::uint64_t>();
+    if (value_size != sizeof(value_t)) {
+        throw std::runtime_error(
+            "checkpoint node size mismatch : " + std::to_string(value_size)
+            + " != " + std::to_string(sizeof(value_t)));
+    }
+    lattice_t result{reader.read<typename lattice_t::sizes_t>()};
+    const auto amount = reader.read<std::uint64_t>();
+    if (amount != result.get_amount_of_nodes()) {
+        throw std::runtime_error(
+            "checkpoint nodes amount mismatch : " + std::to_string(amount)
+            + " != " + std::to_string(result.get_amount_of_nodes()));
+    }
+    reader.read_bytes(result.data(), result.get_amount_of_nodes() * sizeof(value_t));
+    return result;
+}
+
+template<typename lattice_t>
+void write_multilayer(writer_t& writer, const multilayer<lattice_t>& structure)
+{
+    writer.write(static_cast<std::uint64_t>(structure.size()));
+    for (const auto& film_ : structure) {
+        write_lattice(writer, static_cast<const lattice_t&>(film_));
+        writer.write(film_.J);
+    }
+    writer.write_vector(structure.get_J_interlayers());
+}
+
+template<typename lattice_t>
+[[nodiscard]] multilayer<lattice_t> read_multilayer(reader_t& reader)
+{
+    // плёнка -- как минимум размер узла, размеры, число узлов и J
+    const auto amount = reader.read_amount(
+        2 * sizeof(std::uint64_t) + sizeof(typename lattice_t::sizes_t) + sizeof(double));
+    std::vector<film<lattice_t>> films{};
+    films.reserve(amount);
+    for (std::size_t idx = 0; idx < amount; ++idx) {
+        const auto lattice = read_lattice<lattice_t>(reader);
+        films.emplace_back(lattice, reader.read<double>());
+    }
+    auto J_interlayers = reader.read_vector<double>();
+    return multilayer<lattice_t>{std::move(films), std::move(J_interlayers)};
+}
+} // namespace detail
+
+// решётка: размеры и узлы
+template<typename lattice_t>
+void save(const std::string& path, const lattice_t& lattice)
+{
+    detail::writer_t writer{path, kind_t::lattice};
+    detail::write_lattice(writer, lattice);
+    writer.close();
+}
+template<typename lattice_t>
+[[nodiscard]] lattice_t load_lattice(const std::string& path)
+{
+    detail::reader_t reader{path, kind_t::lattice};
+    return detail::read_lattice<lattice_t>(reader);
+}
+
+// плёнка: решётка и J
+template<typename lattice_t>
+void save(const std::string& path, const film<lattice_t>& film_)
+{
+    detail::writer_t writer{path, kind_t::film};
+    detail::write_lattice(writer, static_cast<const lattice_t&>(film_));
+    writer.write(film_.J);
+    writer.close();
+}
+template<typename lattice_t>
+[[nodiscard]] film<lattice_t> load_film(const std::string& path)
+{
+    detail::reader_t reader{path, kind_t::film};
+    const auto lattice = detail::read_lattice<lattice_t>(reader);
+    return film<lattice_t>{lattice, reader.read<double>()};
+}
+
+// многослойная структура: плёнки и межслойные обменные интегралы
+template<typename lattice_t>
+void save(const std::string& path, const multilayer<lattice_t>& structure)
+{
+    detail::writer_t writer{path, kind_t::multilayer};
+    detail::write_multilayer(writer, structure);
+    writer.close();
+}
+template<typename lattice_t>
+[[nodiscard]] multilayer<lattice_t> load_multilayer(const std::string& path)
+{
+    detail::reader_t reader{path, kind_t::multilayer};
+    return detail::read_multilayer<lattice_t>(reader);
+}
+
+/*
+ * система целиком, чтобы счёт продолжился с того же места:
+ * структура, накопленные magns и energies, T, настройки и состояние синхронизации,
+ * порядок обхода, число переотражений, состояния proposals (например ширины конусов cone_proposal_t),
+ * генератор системы (generator) и произвольные состояния других генераторов {rng_states}
+ * (см. random_t::get_state). загружать нужно с тем же proposal_t, что и при сохранении
+ **/
+template<typename multilayer_t, typename proposal_t>
+void save(
+    const std::string& path,
+    const multilayer_system<multilayer_t, proposal_t>& system,
+    const std::vector<std::string>& rng_states = {})
+{
+    detail::writer_t writer{path, kind_t::multilayer_system};
+    detail::write_multilayer(writer, system.nanostructure);
+    writer.write_vector(system.magns);
+    writer.write_vector(system.energies);
+    writer.write(system.T);
+    writer.write(static_cast<std::uint64_t>(system.synchronization_period));
+    writer.write(static_cast<std::uint64_t>(system.synchronization_threads_amount));
+    writer.write(system.energy_drift);
+    writer.write(static_cast<std::uint64_t>(system.get_steps_since_synchronization()));
+    writer.write(static_cast<std::uint8_t>(system.is_energy_absolute()));
+    writer.write(system.sweep_order);
+    writer.write(static_cast<std::uint64_t>(system.over_relaxation_ratio));
+    writer.write(static_cast<std::uint64_t>(sizeof(proposal_t)));
+    writer.write_vector(system.proposals);
+    writer.write_string(system.generator.get_state());
+    writer.write(static_cast<std::uint64_t>(rng_states.size()));
+    for (const auto& state : rng_states) {
+        writer.write_string(state);
+    }
+    writer.close();
+}
+template<typename lattice_t, typename proposal_t = qss::algorithms::metropolis::uniform_proposal_t>
+[[nodiscard]] multilayer_system<multilayer<lattice_t>, proposal_t>
+load_multilayer_system(const std::string& path, std::vector<std::string>* rng_states = nullptr)
+{
+    using magn_t = typename lattice_t::value_t::magn_t;
+    static_assert(std::is_trivially_copyable_v<proposal_t>, "proposals are saved as raw bytes");
+    detail::reader_t reader{path, kind_t::multilayer_system};
+    multilayer_system<multilayer<lattice_t>, proposal_t> result{detail::read_multilayer<lattice_t>(reader)};
+    auto magns = reader.read_vector<magn_t>();
+    auto energies = reader.read_vector<double>();
+    if (magns.size() != result.nanostructure.size() || energies.size() != result.nanostructure.size()) {
+        throw std::runtime_error("checkpoint magns or energies do not match films");
+    }
+    result.magns = std::move(magns);
+    result.energies = std::move(energies);
+    result.T = reader.read<double>();
+    result.synchronization_period = static_cast<std::size_t>(reader.read<std::uint64_t>());
+    result.synchronization_threads_amount = static_cast<std::size_t>(reader.read<std::uint64_t>());
+    result.energy_drift = reader.read<double>();
+    const auto steps_since_synchronization = static_cast<std::size_t>(reader.read<std::uint64_t>());
+    result.restore_synchronization_state(steps_since_synchronization, reader.read<std::uint8_t>() != 0);
+    result.sweep_order = reader.read<qss::algorithms::metropolis::sweep_order_t>();
+    result.over_relaxation_ratio = static_cast<std::size_t>(reader.read<std::uint64_t>());
+    const auto proposal_size = reader.read<std::uint64_t>();
+    if (proposal_size != sizeof(proposal_t)) {
+        throw std::runtime_error(
+            "checkpoint proposal size mismatch : " + std::to_string(proposal_size)
+            + " != " + std::to_string(sizeof(proposal_t)));
+    }
+    auto proposals = reader.read_vector<proposal_t>();
+    if (proposals.size() != result.nanostructure.size()) {
+        throw std::runtime_error("checkpoint proposals do not match films");
+    }
+    result.proposals = std::move(proposals);
+    result.generator.set_state(reader.read_string());
+    // каждое состояние -- как минимум его длина
+    const auto states_amount = reader.read_amount(sizeof(std::uint64_t));
+    std::vector<std::string> states{};
+    states.reserve(states_amount);
+    for (std::size_t idx = 0; idx < states_amount; ++idx) {
+        states.push_back(reader.read_string());
+    }
+    if (rng_states != nullptr) {
+        *rng_states = std::move(states);
+    }
+    return result;
+}
+} // namespace checkpoint
+} // namespace qss
+
+#endif
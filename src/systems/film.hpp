@@ -6,7 +6,11 @@
 #include "../lattices/3d/fcc.hpp"
 #include "../lattices/base_lattice.hpp"
 #include "../lattices/borders_conditions.hpp"
+#include "../lattices/neighbours_table.hpp"
+#include "../utility/parallel.hpp"
+#include "../utility/quantities.hpp"
 
+#include <cstddef>
 #include <type_traits>
 
 #define ThreeD_Lattice typename // to migrate to c++17
@@ -104,6 +108,36 @@ copy_structure(const film<lattice_t<old_spin_t>>& original) noexcept
         copy_structure<spin_t>(dynamic_cast<const lattice_t<old_spin_t>&>(original)), original.J};
 }
 
+// таблица соседей внутри плёнки с её граничными условиями (периодические по XY, резкие по Z)
+template<ThreeD_Lattice lattice_t>
+[[nodiscard]] qss::lattices::neighbours_table_t<lattice_t::neighbours_amount>
+make_neighbours_table(const film<lattice_t>& film_)
+{
+    using film_t = film<lattice_t>;
+    return qss::lattices::make_neighbours_table(
+        film_,
+        qss::borders_conditions::use_border_conditions<
+            typename film_t::xy_border_condition,
+            typename film_t::xy_border_condition,
+            typename film_t::z_border_condition>);
+}
+
+// полная энергия плёнки на узел с её обменным интегралом (см. qss::calculate_energy)
+template<ThreeD_Lattice lattice_t, std::size_t neighbours_amount, typename delta_h_t>
+[[nodiscard]] double calculate_energy(
+    const film<lattice_t>& film_,
+    const qss::lattices::neighbours_table_t<neighbours_amount>& neighbours_table,
+    delta_h_t delta_h,
+    const std::size_t threads_amount = get_default_threads_amount())
+{
+    // delta_h линейна по полю, так что J можно внести в сумму соседей
+    auto film_delta_h = [&delta_h, J = film_.J](const auto& sum, const auto& spin_old, const auto& spin_new) {
+        return delta_h(J * sum, spin_old, spin_new);
+    };
+    return qss::calculate_energy(
+        static_cast<const lattice_t&>(film_), neighbours_table, film_delta_h, threads_amount);
+}
+
 template<ThreeD_Lattice lattice_t>
 // requires std::is_same_v<typename lattice_t::coords_t, qss::lattices::three_d::fcc_coords_t>
 [[nodiscard]] std::optional<qss::lattices::three_d::fcc_coords_t>
@@ -13,10 +13,13 @@
 #include "../random/mersenne.hpp"
 #include "../random/random.hpp"
 #include "../utility/functions.hpp"
+#include "../utility/parallel.hpp"
 #include "film.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <optional>
 #include <type_traits>
 #include <utility>
@@ -75,7 +78,7 @@ public:
     multilayer_coords_t<lattice_t> get_random_coord() const noexcept
     {
         using size_t = typename multilayer_coords_t<lattice_t>::size_type;
-        static auto rand = random_t{qss::random::get_seed()};
+        static thread_local auto rand = random_t{qss::random::get_seed()};
         const size_t idx = static_cast<size_t>(rand(0, static_cast<size_t>(this->size())));
         const auto coord = this->at(idx).choose_random_node();
         return {idx, coord};
@@ -134,52 +137,95 @@ public:
         return J_interlayers;
     }
 
+    /*
+     * сумма соседей узла с обменными интегралами: внутри плёнки умножается на film.J,
+     * соседи за пределами плёнки берутся из соседних плёнок с J_interlayers.
+     * плёнки берутся по ссылке, без копирования
+     **/
     [[nodiscard]] typename film_t::value_t::magn_t
     get_sum_of_closest_neighbours(const coords_t& central_) const noexcept
     {
-        const auto idx = central_.idx;
-        const auto central = central_.film_coord;
-        const auto film = this->at(idx);
-        bool has_upper = idx != size() - 1u;
-        bool has_lower = idx != 0;
-
         using magn_t = typename film_t::value_t::magn_t;
-        auto borders_conditions
-            = [](const typename film_t::coords_t& coord_, const typename film_t::sizes_t& sizes) {
-                  return qss::borders_conditions::use_border_conditions<
-                      typename film_t::xy_border_condition,
-                      typename film_t::xy_border_condition,
-                      typename film_t::z_border_condition>(coord_, sizes);
-              };
-        auto neigs = get_closest_neighbours(central);
-        const auto sizes = film.sizes;
+        const auto& film = (*this)[central_.idx];
+        const auto& central = central_.film_coord;
+        const auto neigs = get_closest_neighbours(central);
 
         magn_t sum{};
-        magn_t upper_neig_val{};
-        magn_t lower_neig_val{};
-        for (auto it = neigs.begin(); it != neigs.end(); ++it) {
-            const auto coord = borders_conditions(*it, sizes);
+        unsigned int outer_amount = 0;
+        for (const auto& neig : neigs) {
+            const auto coord = qss::borders_conditions::use_border_conditions<
+                typename film_t::xy_border_condition,
+                typename film_t::xy_border_condition,
+                typename film_t::z_border_condition>(neig, film.sizes);
             if (coord) {
-                sum += film.get(coord.value());
+                sum += film.get_unchecked(coord.value());
             } else {
-                if (has_upper) {
-                    const auto neig
-                        = get_closest_neigbour_from_upper_film(this->at(idx + 1u), central);
-                    upper_neig_val += neig ? this->at(idx + 1u).get(neig.value()) : magn_t{};
-                }
-                if (has_lower) {
-                    const auto neig
-                        = get_closest_neigbour_from_lower_film(this->at(idx - 1u), central);
-                    lower_neig_val += neig ? this->at(idx - 1u).get(neig.value()) : magn_t{};
-                }
+                ++outer_amount;
             }
         }
-        sum *= film.J;
-        if (has_upper) {
-            sum += J_interlayers[idx] * upper_neig_val;
+        sum = film.J * sum;
+        if (outer_amount != 0) {
+            sum += get_interlayer_sum_of_closest_neighbours(central_, outer_amount);
         }
-        if (has_lower) {
-            sum += J_interlayers[idx - 1u] * lower_neig_val;
+        return sum;
+    }
+
+    // то же по номеру узла {node_idx} в плёнке {film_idx} и таблице соседей этой плёнки
+    template<std::size_t neighbours_amount>
+    [[nodiscard]] typename film_t::value_t::magn_t get_sum_of_closest_neighbours(
+        const typename coords_t::size_type film_idx,
+        const typename film_t::idx_t node_idx,
+        const qss::lattices::neighbours_table_t<neighbours_amount>& neighbours_table) const noexcept
+    {
+        using magn_t = typename film_t::value_t::magn_t;
+        using table_t = qss::lattices::neighbours_table_t<neighbours_amount>;
+        const auto& film = (*this)[film_idx];
+
+        magn_t sum{};
+        unsigned int outer_amount = 0;
+        for (const auto neig : neighbours_table[node_idx]) {
+            if (neig == table_t::npos) {
+                ++outer_amount;
+            } else {
+                sum += film.get_by_idx(neig);
+            }
+        }
+        sum = film.J * sum;
+        if (outer_amount != 0) {
+            sum += get_interlayer_sum_of_closest_neighbours({film_idx, film.get_coords(node_idx)}, outer_amount);
+        }
+        return sum;
+    }
+
+    /*
+     * межслойная часть суммы соседей из get_sum_of_closest_neighbours, уже умноженная на J_interlayers:
+     * {outer_amount} -- число соседей узла, выходящих за пределы его плёнки.
+     * плёнки берутся по ссылке, без копирования
+     **/
+    [[nodiscard]] typename film_t::value_t::magn_t get_interlayer_sum_of_closest_neighbours(
+        const coords_t& central_, const unsigned int outer_amount) const noexcept
+    {
+        using magn_t = typename film_t::value_t::magn_t;
+        const auto idx = central_.idx;
+        const auto& central = central_.film_coord;
+        magn_t sum{};
+        if (outer_amount == 0) {
+            return sum;
+        }
+        const double amount = static_cast<double>(outer_amount);
+        if (idx != size() - 1u) {
+            const auto& upper = (*this)[idx + 1u];
+            const auto neig = get_closest_neigbour_from_upper_film(upper, central);
+            if (neig) {
+                sum += (J_interlayers[idx] * amount) * upper.get_unchecked(neig.value());
+            }
+        }
+        if (idx != 0) {
+            const auto& lower = (*this)[idx - 1u];
+            const auto neig = get_closest_neigbour_from_lower_film(lower, central);
+            if (neig) {
+                sum += (J_interlayers[idx - 1u] * amount) * lower.get_unchecked(neig.value());
+            }
         }
         return sum;
     }
@@ -194,6 +240,66 @@ public:
     }
 };
 
+// таблицы соседей внутри каждой плёнки (см. make_neighbours_table для плёнки)
+template<ThreeD_Lattice lattice_t>
+[[nodiscard]] std::vector<qss::lattices::neighbours_table_t<lattice_t::neighbours_amount>>
+make_neighbours_tables(const multilayer<lattice_t>& structure)
+{
+    std::vector<qss::lattices::neighbours_table_t<lattice_t::neighbours_amount>> result{};
+    result.reserve(structure.size());
+    for (const auto& film_ : structure) {
+        result.push_back(make_neighbours_table(film_));
+    }
+    return result;
+}
+
+/*
+ * полные энергии плёнок на узел, включая межслойные связи:
+ * поле узла h_i то же, что даёт multilayer::get_sum_of_closest_neighbours,
+ * энергия плёнки -1/2 sum_i delta_h(h_i, s_i, 0) / N_film, так что связь между плёнками
+ * делится между ними пополам, а сумма E_film * N_film по плёнкам -- полная энергия.
+ * узлы каждой плёнки делятся между {threads_amount} потоками
+ **/
+template<ThreeD_Lattice lattice_t, std::size_t neighbours_amount, typename delta_h_t>
+[[nodiscard]] std::vector<double> calculate_energies(
+    const multilayer<lattice_t>& structure,
+    const std::vector<qss::lattices::neighbours_table_t<neighbours_amount>>& neighbours_tables,
+    delta_h_t delta_h,
+    const std::size_t threads_amount = get_default_threads_amount())
+{
+    using film_t = typename multilayer<lattice_t>::film_t;
+    using value_t = typename film_t::value_t;
+    if (neighbours_tables.size() != structure.size()) {
+        throw std::logic_error(
+            "neighbours tables do not match multilayer : " + std::to_string(neighbours_tables.size())
+            + " != " + std::to_string(structure.size()));
+    }
+
+    std::vector<double> result(structure.size(), 0.0);
+    std::vector<double> energies(threads_amount, 0.0);
+    for (std::size_t film_idx = 0; film_idx < structure.size(); ++film_idx) {
+        const auto& film_ = structure[film_idx];
+        const auto& table = neighbours_tables[film_idx];
+        const auto amount = film_.get_amount_of_nodes();
+        qss::parallel_run(threads_amount, [&](const std::size_t thread_idx) {
+            const auto [first, last] = qss::get_chunk(amount, thread_idx, threads_amount);
+            double energy = 0.0;
+            for (auto idx = first; idx < last; ++idx) {
+                const auto sum = structure.get_sum_of_closest_neighbours(
+                    static_cast<typename multilayer<lattice_t>::coords_t::size_type>(film_idx), idx, table);
+                energy += delta_h(sum, film_.get_by_idx(idx), value_t::zero());
+            }
+            energies[thread_idx] = energy;
+        });
+        double energy = 0.0;
+        for (const auto part : energies) {
+            energy += part;
+        }
+        result[film_idx] = -0.5 * energy / static_cast<double>(amount);
+    }
+    return result;
+}
+
 template<typename spin_t, typename old_spin_t, template<typename = old_spin_t> class lattice_t>
 // requires ThreeD_Lattice<lattice_t<old_spin_t>>
 [[nodiscard]] constexpr multilayer<lattice_t<spin_t>>
@@ -1,21 +1,82 @@
 #ifndef MULTILAYER_SYSTEM_HPP_INCLUDED
 #define MULTILAYER_SYSTEM_HPP_INCLUDED
 
+#include "../algorithms/Metropolis.hpp"
+#include "../algorithms/over_relaxation.hpp"
+#include "../lattices/neighbours_table.hpp"
+#include "../random/mersenne.hpp"
+#include "../random/random.hpp"
+#include "../utility/quantities.hpp"
+#include "../utility/statistics.hpp"
 #include "multilayer.hpp"
 
+#include <cmath>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace qss {
 inline namespace nanostructures {
 
-template<typename multilayer_t>
+/*
+ * magns -- намагниченности плёнок на узел, energies -- энергии плёнок на узел,
+ * обновляются по изменениям из шагов Метрополиса.
+ * до первого вызова synchronize() энергии отсчитываются от нуля, после -- абсолютные
+ * (см. calculate_energies: межслойные связи делятся между плёнками пополам,
+ * а между синхронизациями изменение межслойной связи целиком относится к плёнке перевёрнутого спина,
+ * поэтому точной остаётся сумма по плёнкам, а не каждая энергия в отдельности).
+ * при synchronization_period > 0 evolve сам синхронизирует значения каждые synchronization_period шагов.
+ * при QSS_STATISTICS statistics[idx] накапливает счётчики шагов плёнки idx (см. utility/statistics.hpp).
+ * proposals[idx] -- способ предложить новый спин в плёнке idx (см. algorithms/proposals.hpp),
+ * у каждой плёнки свой, так как подстраиваемые параметры зависят от её J и анизотропии,
+ * подстраиваются они только в thermalize.
+ * over_relaxation_ratio -- число проходов переотражений (algorithms/over_relaxation.hpp)
+ * после каждого шага Метрополиса в плёнке, только для спинов Гейзенберга.
+ * generator -- генератор системы, из него evolve(delta_h) берёт все случайные числа,
+ * так что шаг системы не зависит от того, в каком потоке он выполняется,
+ * а его состояние сохраняется в контрольной точке и продолженный счёт повторяет траекторию
+ **/
+template<typename multilayer_t, typename proposal_t = qss::algorithms::metropolis::uniform_proposal_t>
 struct multilayer_system {
+    using generator_t = qss::random::mersenne::random_t<>;
+
     multilayer_t nanostructure;
     std::vector<typename multilayer_t::film_t::value_t::magn_t> magns{};
     std::vector<double> energies{};
     double T{0.0};
+    std::size_t synchronization_period{0};
+    std::size_t synchronization_threads_amount{1};
+    double energy_drift{0.0}; // расхождение полной энергии на узел при последней синхронизации
+    qss::algorithms::metropolis::sweep_order_t sweep_order{qss::algorithms::metropolis::sweep_order_t::random};
+    std::vector<qss::step_statistics_t> statistics{};
+    std::vector<proposal_t> proposals{};
+    std::size_t over_relaxation_ratio{0};
+    generator_t generator{qss::random::get_seed()};
+
+private:
+    using table_t = qss::lattices::neighbours_table_t<multilayer_t::film_t::neighbours_amount>;
+    std::vector<table_t> neighbours_tables{};
+    std::size_t steps_since_synchronization{0};
+    bool is_synchronized{false};
+
+    /*
+     * nanostructure открыт для изменения, поэтому таблицы перестраиваются,
+     * если число плёнок или узлов какой-либо плёнки не совпадает с построенными
+     **/
+    void update_neighbours_tables()
+    {
+        bool is_actual = neighbours_tables.size() == nanostructure.size();
+        for (std::size_t idx = 0; is_actual && idx < nanostructure.size(); ++idx) {
+            is_actual = neighbours_tables[idx].get_amount_of_nodes() == nanostructure[idx].get_amount_of_nodes();
+        }
+        if (!is_actual) {
+            neighbours_tables = make_neighbours_tables(nanostructure);
+        }
+    }
+
+public:
 
-    [[nodiscard]] constexpr multilayer_system(multilayer_t&& structure) noexcept
+    [[nodiscard]] constexpr multilayer_system(multilayer_t&& structure)
         : nanostructure{std::move(structure)}
     {
         magns.reserve(nanostructure.size());
@@ -24,8 +85,10 @@ struct multilayer_system {
             magns.push_back(calculate_magn(film));
             energies.push_back(0.0);
         }
+        statistics.resize(nanostructure.size());
+        proposals.resize(nanostructure.size());
     }
-    [[nodiscard]] constexpr multilayer_system(const multilayer_t& structure) noexcept
+    [[nodiscard]] constexpr multilayer_system(const multilayer_t& structure)
         : nanostructure{structure}
     {
         magns.reserve(nanostructure.size());
@@ -34,6 +97,8 @@ struct multilayer_system {
             magns.push_back(calculate_magn(film));
             energies.push_back(0.0);
         }
+        statistics.resize(nanostructure.size());
+        proposals.resize(nanostructure.size());
     }
 
     /*
@@ -43,7 +108,11 @@ struct multilayer_system {
     */
     /*
      * использует алгоритм Метрополиса
-     * необходимо установить температуру, перед использованием
+     * необходимо установить температуру, перед использованием.
+     * соседи берутся из таблиц соседей плёнок, они строятся при первом вызове и после смены размеров плёнок,
+     * узлы каждой плёнки обходятся в порядке sweep_order,
+     * затем плёнка проходится over_relaxation_ratio раз переотражениями.
+     * случайные числа -- из generator
      **/
     template<typename delta_h_t>
     void evolve(
@@ -51,35 +120,129 @@ struct multilayer_system {
                                const typename multilayer_t::film_t::value_t& spin_old,
                                const typename multilayer_t::film_t::value_t& spin_new) -> double {
             return scalar_multiply(sum, spin_old - spin_new);
-        }) noexcept
+        })
     {
+        evolve(std::move(delta_h), generator);
+    }
+    /*
+     * то же, но все случайные числа шага берутся из {rand}
+     * (например потока реплики в parallel_tempering), и шаг воспроизводим в любом потоке
+     **/
+    template<typename delta_h_t, typename random_t>
+    void evolve(delta_h_t delta_h, random_t& rand)
+    {
+        update_neighbours_tables();
         for (std::uint8_t idx = 0; idx < nanostructure.size(); ++idx) {
+            const auto& table = neighbours_tables[idx];
             auto delta_energy_f
-                = [&delta_h, &idx, this](
+                = [&delta_h, &table, idx, this](
                       const typename multilayer_t::film_t& lattice_,
-                      const typename multilayer_t::film_t::coords_t& central,
+                      const typename multilayer_t::film_t::idx_t central,
                       const typename multilayer_t::film_t::value_t& new_spin) -> double {
-                const auto sum = nanostructure.get_sum_of_closest_neighbours({idx, central});
-                return delta_h(sum, lattice_.get(central), new_spin);
+                const auto sum = nanostructure.get_sum_of_closest_neighbours(idx, central, table);
+                return delta_h(sum, lattice_.get_by_idx(central), new_spin);
             };
 
-            auto [M, E]
-                = qss::algorithms::metropolis::make_step(nanostructure[idx], delta_energy_f, T);
+            QSS_STATISTICS_ONLY(const auto statistics_before = qss::get_thread_statistics();)
+            auto [M, E] = qss::algorithms::metropolis::make_step(
+                nanostructure[idx], delta_energy_f, T, sweep_order, proposals[idx], rand);
+            QSS_STATISTICS_ONLY(statistics[idx] += qss::get_thread_statistics() - statistics_before;)
+            if constexpr (qss::algorithms::over_relaxation::is_applicable_v<typename multilayer_t::film_t::value_t>) {
+                auto local_field_f = [&delta_h, &table, idx, this](
+                                         const typename multilayer_t::film_t&,
+                                         const typename multilayer_t::film_t::idx_t central) {
+                    const auto sum = nanostructure.get_sum_of_closest_neighbours(idx, central, table);
+                    return qss::algorithms::over_relaxation::get_effective_field(delta_h, sum);
+                };
+                for (std::size_t pass = 0; pass < over_relaxation_ratio; ++pass) {
+                    // энергия не меняется
+                    M += qss::algorithms::over_relaxation::make_step(nanostructure[idx], local_field_f).first;
+                }
+            }
             magns[idx] += M / static_cast<double>(nanostructure[idx].get_amount_of_nodes());
-            energies[idx]
-                += -0.5 * E / static_cast<double>(nanostructure[idx].get_amount_of_nodes());
+            energies[idx] += E / static_cast<double>(nanostructure[idx].get_amount_of_nodes());
+        }
+        if (synchronization_period != 0 && ++steps_since_synchronization >= synchronization_period) {
+            synchronize(delta_h, synchronization_threads_amount);
+        }
+    }
+
+    /*
+     * термализация: {sweeps} вызовов evolve(delta_h), во время которых proposals подстраиваются
+     * (proposal_t::tune), после неё подстройка выключена и шаги удовлетворяют детальному балансу
+     **/
+    template<typename delta_h_t>
+    void thermalize(delta_h_t delta_h, const std::size_t sweeps)
+    {
+        for (auto& proposal : proposals) {
+            proposal.tune(sweeps);
+        }
+        for (std::size_t sweep = 0; sweep < sweeps; ++sweep) {
+            evolve(delta_h);
+        }
+    }
+
+    // true, если energies абсолютные (была хотя бы одна синхронизация)
+    [[nodiscard]] bool is_energy_absolute() const noexcept
+    {
+        return is_synchronized;
+    }
+    // шагов evolve с последней синхронизации
+    [[nodiscard]] std::size_t get_steps_since_synchronization() const noexcept
+    {
+        return steps_since_synchronization;
+    }
+    // для контрольных точек: восстанавливает счётчик и признак синхронизации сохранённой системы
+    void restore_synchronization_state(const std::size_t steps, const bool is_energy_absolute_) noexcept
+    {
+        steps_since_synchronization = steps;
+        is_synchronized = is_energy_absolute_;
+    }
+
+    /*
+     * пересчитывает намагниченности и энергии плёнок целиком и заменяет ими накопленные значения.
+     * возвращает расхождение накопленной и пересчитанной полной энергии на узел
+     * (0 при первом вызове, когда накопленные энергии ещё не абсолютные)
+     **/
+    template<typename delta_h_t>
+    double synchronize(delta_h_t delta_h, const std::size_t threads_amount = 1)
+    {
+        update_neighbours_tables();
+        const auto calculated = calculate_energies(nanostructure, neighbours_tables, delta_h, threads_amount);
+        double tracked_energy = 0.0;
+        double calculated_energy = 0.0;
+        std::size_t amount = 0;
+        for (std::size_t idx = 0; idx < nanostructure.size(); ++idx) {
+            const auto film_amount = nanostructure[idx].get_amount_of_nodes();
+            tracked_energy += energies[idx] * static_cast<double>(film_amount);
+            calculated_energy += calculated[idx] * static_cast<double>(film_amount);
+            amount += film_amount;
+            energies[idx] = calculated[idx];
+            magns[idx] = calculate_magn(nanostructure[idx]);
         }
+        energy_drift
+            = is_synchronized ? std::abs(tracked_energy - calculated_energy) / static_cast<double>(amount) : 0.0;
+        is_synchronized = true;
+        steps_since_synchronization = 0;
+        return energy_drift;
     }
 };
 
-template<typename spin_t, typename old_spin_t, template<typename = old_spin_t> class lattice_t>
-[[nodiscard]] constexpr multilayer_system<multilayer<lattice_t<spin_t>>>
-copy_structure(const multilayer_system<multilayer<lattice_t<old_spin_t>>>& original) noexcept
+/*
+ * та же структура со спинами spin_t, способы предложить спин (proposals) переносятся
+ **/
+template<typename spin_t, typename old_spin_t, template<typename = old_spin_t> class lattice_t, typename proposal_t>
+[[nodiscard]] constexpr multilayer_system<multilayer<lattice_t<spin_t>>, proposal_t>
+copy_structure(const multilayer_system<multilayer<lattice_t<old_spin_t>>, proposal_t>& original)
 {
     if constexpr (std::is_same_v<old_spin_t, spin_t>) {
         return original;
+    } else {
+        multilayer_system<multilayer<lattice_t<spin_t>>, proposal_t> result{
+            copy_structure<spin_t>(original.nanostructure)};
+        result.proposals = original.proposals;
+        return result;
     }
-    return {copy_structure<spin_t>(original.nanostructure)};
 }
 } // namespace nanostructures
 } // namespace qss
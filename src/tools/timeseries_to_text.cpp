@@ -0,0 +1,63 @@
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../utility/timeseries.hpp"
+
+// переводит двоичный временной ряд (utility/timeseries.hpp) в текст:
+// первая строка -- имена столбцов после '#', дальше строки через табуляцию
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <input> [output]\n";
+        return 1;
+    }
+    try
+    {
+        qss::timeseries_reader_t reader{argv[1]};
+        std::ofstream file{};
+        if (argc == 3)
+        {
+            file.open(argv[2]);
+            if (!file)
+            {
+                std::cerr << "cannot open " << argv[2] << "\n";
+                return 1;
+            }
+        }
+        std::ostream &out = argc == 3 ? file : std::cout;
+        out.precision(std::numeric_limits<double>::max_digits10);
+
+        const auto &names = reader.get_names();
+        out << "#";
+        for (std::size_t idx = 0; idx < names.size(); ++idx)
+        {
+            out << (idx == 0 ? " " : "\t") << names[idx];
+        }
+        out << "\n";
+
+        std::vector<std::vector<double>> columns{};
+        while (reader.read_block(columns))
+        {
+            const auto rows = columns.empty() ? 0 : columns.front().size();
+            for (std::size_t row = 0; row < rows; ++row)
+            {
+                for (std::size_t idx = 0; idx < columns.size(); ++idx)
+                {
+                    out << (idx == 0 ? "" : "\t") << columns[idx][row];
+                }
+                out << "\n";
+            }
+        }
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
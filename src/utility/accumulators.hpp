@@ -0,0 +1,286 @@
+#ifndef ACCUMULATORS_HPP_INCLUDED
+#define ACCUMULATORS_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace qss
+{
+    /*
+     * среднее и дисперсия ряда без хранения самого ряда (алгоритм Уэлфорда)
+     * и оценка ошибки среднего с учётом автокорреляций методом логарифмического биннинга:
+     * на уровне k хранятся статистики средних по блокам из 2^k подряд идущих значений.
+     * ошибка на уровне k -- sqrt(var_k / n_k), для независимых блоков она выходит на плато
+     **/
+    class binning_accumulator_t
+    {
+        struct level_t
+        {
+            std::size_t count = 0;
+            double mean = 0.0;
+            double m2 = 0.0; // сумма квадратов отклонений от среднего
+            double pending = 0.0;
+            bool has_pending = false;
+
+            void add(const double value) noexcept
+            {
+                ++count;
+                const double delta = value - mean;
+                mean += delta / static_cast<double>(count);
+                m2 += delta * (value - mean);
+            }
+            [[nodiscard]] double get_variance() const noexcept
+            {
+                return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0;
+            }
+        };
+        std::vector<level_t> levels = std::vector<level_t>(1);
+
+    public:
+        // меньше блоков на уровне -- оценка ошибки уже ненадёжна
+        static constexpr std::size_t min_bins_amount = 32;
+
+        void add(double value)
+        {
+            for (std::size_t k = 0;; ++k)
+            {
+                if (k == levels.size())
+                {
+                    levels.emplace_back();
+                }
+                auto &level = levels[k];
+                level.add(value);
+                if (!level.has_pending)
+                {
+                    level.pending = value;
+                    level.has_pending = true;
+                    return;
+                }
+                value = 0.5 * (level.pending + value);
+                level.has_pending = false;
+            }
+        }
+
+        [[nodiscard]] std::size_t get_count() const noexcept
+        {
+            return levels[0].count;
+        }
+        [[nodiscard]] double get_mean() const noexcept
+        {
+            return levels[0].mean;
+        }
+        [[nodiscard]] double get_variance() const noexcept
+        {
+            return levels[0].get_variance();
+        }
+        // число уровней, на которых не меньше min_bins_amount блоков
+        [[nodiscard]] std::size_t get_levels_amount() const noexcept
+        {
+            std::size_t result = 0;
+            while (result < levels.size() && levels[result].count >= min_bins_amount)
+            {
+                ++result;
+            }
+            return result;
+        }
+        [[nodiscard]] double get_error(const std::size_t level) const
+        {
+            if (level >= levels.size())
+            {
+                throw std::out_of_range("binning level out of range : " + std::to_string(level) +
+                                        " >= " + std::to_string(levels.size()));
+            }
+            const auto &bins = levels[level];
+            return bins.count > 1 ? std::sqrt(bins.get_variance() / static_cast<double>(bins.count)) : 0.0;
+        }
+        // наибольшая ошибка по надёжным уровням (консервативная оценка плато)
+        [[nodiscard]] double get_error() const noexcept
+        {
+            double result = 0.0;
+            const auto amount = std::max(get_levels_amount(), std::size_t{1});
+            for (std::size_t level = 0; level < amount; ++level)
+            {
+                result = std::max(result, get_error(level));
+            }
+            return result;
+        }
+        // интегральное время автокорреляции: tau = 1/2 (error / error_0)^2
+        [[nodiscard]] double get_autocorrelation_time() const noexcept
+        {
+            const double naive = levels[0].count > 1 ? get_error(0) : 0.0;
+            if (naive == 0.0)
+            {
+                return 0.0;
+            }
+            const double ratio = get_error() / naive;
+            return 0.5 * ratio * ratio;
+        }
+    };
+
+    // среднее значение и его ошибка
+    struct estimate_t
+    {
+        double mean = 0.0;
+        double error = 0.0;
+    };
+    inline std::ostream &operator<<(std::ostream &out, const estimate_t &data) noexcept
+    {
+        out << data.mean << "\t" << data.error;
+        return out;
+    }
+
+    /*
+     * итог по ряду измерений одной системы из {nodes_amount} узлов при температуре T:
+     * моменты |M|, M^2, M^4 намагниченности на узел и E, E^2 энергии на узел с ошибками,
+     * восприимчивость chi = N (<M^2> - <|M|>^2) / T, теплоёмкость на узел C = N (<E^2> - <E>^2) / T^2
+     * и кумулянт Биндера U = 1 - <M^4> / (3 <M^2>^2)
+     **/
+    struct observables_summary_t
+    {
+        std::size_t count = 0;
+        estimate_t magn{};
+        estimate_t magn2{};
+        estimate_t magn4{};
+        estimate_t energy{};
+        estimate_t energy2{};
+        double magn_autocorrelation_time = 0.0;
+        double energy_autocorrelation_time = 0.0;
+        double susceptibility = 0.0;
+        double heat_capacity = 0.0;
+        double binder_cumulant = 0.0;
+    };
+    // одной строкой через табуляцию, в порядке полей
+    inline std::ostream &operator<<(std::ostream &out, const observables_summary_t &data) noexcept
+    {
+        out << data.count << "\t"
+            << data.magn << "\t"
+            << data.magn2 << "\t"
+            << data.magn4 << "\t"
+            << data.energy << "\t"
+            << data.energy2 << "\t"
+            << data.magn_autocorrelation_time << "\t"
+            << data.energy_autocorrelation_time << "\t"
+            << data.susceptibility << "\t"
+            << data.heat_capacity << "\t"
+            << data.binder_cumulant;
+        return out;
+    }
+
+    /*
+     * накопитель наблюдаемых одной системы (решётки или плёнки):
+     * add(magn, energy) раз в шаг Монте-Карло, magn и energy -- на узел
+     * (как calculate_magn и энергии multilayer_system), на выходе только итог get_summary
+     **/
+    class observables_accumulator_t
+    {
+        binning_accumulator_t magn{};
+        binning_accumulator_t magn2{};
+        binning_accumulator_t magn4{};
+        binning_accumulator_t energy{};
+        binning_accumulator_t energy2{};
+
+        static estimate_t get_estimate(const binning_accumulator_t &accumulator) noexcept
+        {
+            return {accumulator.get_mean(), accumulator.get_error()};
+        }
+
+    public:
+        template <typename magn_t>
+        void add(const magn_t &magn_, const double energy_)
+        {
+            double magn_abs = 0.0;
+            if constexpr (std::is_arithmetic_v<magn_t>)
+            {
+                magn_abs = std::abs(static_cast<double>(magn_));
+            }
+            else
+            {
+                magn_abs = abs(magn_);
+            }
+            const double magn_sqr = magn_abs * magn_abs;
+            magn.add(magn_abs);
+            magn2.add(magn_sqr);
+            magn4.add(magn_sqr * magn_sqr);
+            energy.add(energy_);
+            energy2.add(energy_ * energy_);
+        }
+
+        [[nodiscard]] std::size_t get_count() const noexcept
+        {
+            return magn.get_count();
+        }
+
+        [[nodiscard]] observables_summary_t get_summary(const double T, const std::size_t nodes_amount) const noexcept
+        {
+            observables_summary_t result{};
+            result.count = get_count();
+            result.magn = get_estimate(magn);
+            result.magn2 = get_estimate(magn2);
+            result.magn4 = get_estimate(magn4);
+            result.energy = get_estimate(energy);
+            result.energy2 = get_estimate(energy2);
+            result.magn_autocorrelation_time = magn.get_autocorrelation_time();
+            result.energy_autocorrelation_time = energy.get_autocorrelation_time();
+            if (result.count == 0)
+            {
+                return result;
+            }
+            const double N = static_cast<double>(nodes_amount);
+            result.susceptibility = N * (result.magn2.mean - result.magn.mean * result.magn.mean) / T;
+            result.heat_capacity = N * (result.energy2.mean - result.energy.mean * result.energy.mean) / (T * T);
+            result.binder_cumulant =
+                result.magn2.mean > 0.0 ? 1.0 - result.magn4.mean / (3.0 * result.magn2.mean * result.magn2.mean) : 0.0;
+            return result;
+        }
+    };
+
+    /*
+     * накопители для каждой плёнки многослойной структуры:
+     * add(system.magns, system.energies) раз в шаг Монте-Карло
+     **/
+    class films_accumulator_t
+    {
+        std::vector<observables_accumulator_t> films{};
+
+    public:
+        template <typename magn_t>
+        void add(const std::vector<magn_t> &magns, const std::vector<double> &energies)
+        {
+            if (magns.size() != energies.size())
+            {
+                throw std::logic_error("magns and energies must be of equal size : " + std::to_string(magns.size()) +
+                                       " != " + std::to_string(energies.size()));
+            }
+            if (films.empty())
+            {
+                films.resize(magns.size());
+            }
+            if (films.size() != magns.size())
+            {
+                throw std::logic_error("number of films changed : " + std::to_string(magns.size()) +
+                                       " != " + std::to_string(films.size()));
+            }
+            for (std::size_t idx = 0; idx < films.size(); ++idx)
+            {
+                films[idx].add(magns[idx], energies[idx]);
+            }
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return films.size();
+        }
+        [[nodiscard]] const observables_accumulator_t &operator[](const std::size_t idx) const noexcept
+        {
+            return films[idx];
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef ASYNC_WRITER_HPP_INCLUDED
+#define ASYNC_WRITER_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "timeseries.hpp"
+
+namespace qss
+{
+    /*
+     * ограниченная очередь без блокировок для одного писателя и одного читателя.
+     * ёмкость округляется вверх до степени двойки, индексы растут неограниченно
+     **/
+    template <typename record_t>
+    class spsc_queue_t
+    {
+        static constexpr std::size_t cache_line = 64;
+
+        std::size_t mask;
+        std::unique_ptr<record_t[]> buffer;
+        alignas(cache_line) std::atomic<std::size_t> head{0}; // следующая запись для чтения
+        alignas(cache_line) std::atomic<std::size_t> tail{0}; // следующее свободное место
+
+        [[nodiscard]] static std::size_t round_up(const std::size_t value) noexcept
+        {
+            std::size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    public:
+        explicit spsc_queue_t(const std::size_t capacity)
+            : mask{round_up(std::max(capacity, std::size_t{2})) - 1},
+              buffer{std::make_unique<record_t[]>(mask + 1)}
+        {
+        }
+
+        [[nodiscard]] std::size_t get_capacity() const noexcept
+        {
+            return mask + 1;
+        }
+
+        // только писатель
+        [[nodiscard]] bool try_push(record_t &&record) noexcept(std::is_nothrow_move_assignable_v<record_t>)
+        {
+            const auto current = tail.load(std::memory_order_relaxed);
+            if (current - head.load(std::memory_order_acquire) > mask)
+            {
+                return false;
+            }
+            buffer[current & mask] = std::move(record);
+            tail.store(current + 1, std::memory_order_release);
+            return true;
+        }
+        // только читатель
+        [[nodiscard]] bool try_pop(record_t &record) noexcept(std::is_nothrow_move_assignable_v<record_t>)
+        {
+            const auto current = head.load(std::memory_order_relaxed);
+            if (current == tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            record = std::move(buffer[current & mask]);
+            head.store(current + 1, std::memory_order_release);
+            return true;
+        }
+    };
+
+    // что делать, если очередь заполнена: ждать освобождения места или выбросить запись с подсчётом
+    enum class backpressure_t
+    {
+        block,
+        drop,
+    };
+
+    /*
+     * фоновая запись: push() кладёт запись в очередь и сразу возвращается,
+     * отдельный поток достаёт записи и передаёт их в sink_f(record).
+     * деструктор (или close()) дописывает всё, что осталось в очереди.
+     * исключение из sink_f останавливает запись и пробрасывается из close()
+     **/
+    template <typename record_t, typename sink_f_t>
+    class async_writer_t
+    {
+        spsc_queue_t<record_t> queue;
+        sink_f_t sink_f;
+        backpressure_t policy;
+        std::atomic<bool> stopped{false};
+        std::atomic<bool> failed{false};
+        std::atomic<std::size_t> dropped{0};
+        std::exception_ptr error{};
+        std::thread worker{};
+
+        void work()
+        {
+            record_t record{};
+            while (true)
+            {
+                if (queue.try_pop(record))
+                {
+                    try
+                    {
+                        sink_f(record);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                        failed.store(true, std::memory_order_release);
+                        return;
+                    }
+                    continue;
+                }
+                if (stopped.load(std::memory_order_acquire))
+                {
+                    // писатель остановлен: всё, что он успел положить, уже видно
+                    if (!queue.try_pop(record))
+                    {
+                        return;
+                    }
+                    try
+                    {
+                        sink_f(record);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                        failed.store(true, std::memory_order_release);
+                        return;
+                    }
+                    continue;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds{50});
+            }
+        }
+
+    public:
+        async_writer_t(sink_f_t sink_f_,
+                       const std::size_t capacity = 1 << 12,
+                       const backpressure_t policy_ = backpressure_t::block)
+            : queue{capacity},
+              sink_f{std::move(sink_f_)},
+              policy{policy_}
+        {
+            worker = std::thread{[this]()
+                                 { work(); }};
+        }
+        async_writer_t(const async_writer_t &) = delete;
+        async_writer_t &operator=(const async_writer_t &) = delete;
+        ~async_writer_t() noexcept
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        /*
+         * возвращает false, если запись выброшена (backpressure_t::drop при полной очереди
+         * или после ошибки в sink_f)
+         **/
+        bool push(record_t record)
+        {
+            if (stopped.load(std::memory_order_relaxed) || failed.load(std::memory_order_acquire))
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            while (!queue.try_push(std::move(record)))
+            {
+                if (policy == backpressure_t::drop || failed.load(std::memory_order_acquire))
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        // сколько записей выброшено
+        [[nodiscard]] std::size_t get_dropped_amount() const noexcept
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        void close()
+        {
+            if (!worker.joinable())
+            {
+                return;
+            }
+            stopped.store(true, std::memory_order_release);
+            worker.join();
+            if (error)
+            {
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+        }
+    };
+
+    /*
+     * строка временного ряда фиксированной ёмкости: не требует выделения памяти,
+     * поэтому передаётся через очередь без обращений к куче
+     **/
+    struct timeseries_row_t
+    {
+        static constexpr std::size_t max_columns = 32;
+        std::array<double, max_columns> values{};
+        std::uint32_t size = 0;
+    };
+
+    /*
+     * временной ряд (timeseries_writer_t), который пишется в фоновом потоке:
+     * add() только копирует строку в очередь
+     **/
+    class async_timeseries_writer_t
+    {
+        struct sink_t
+        {
+            std::unique_ptr<timeseries_writer_t> writer;
+
+            void operator()(const timeseries_row_t &row)
+            {
+                writer->add(row.values.data(), row.size);
+            }
+        };
+
+        std::size_t columns_amount;
+        timeseries_writer_t *writer; // принадлежит sink_t, живёт до закрытия
+        async_writer_t<timeseries_row_t, sink_t> async_writer;
+
+    public:
+        async_timeseries_writer_t(const std::string &path,
+                                  const std::vector<std::string> &names,
+                                  const std::size_t capacity = 1 << 12,
+                                  const backpressure_t policy = backpressure_t::block)
+            : async_timeseries_writer_t{std::make_unique<timeseries_writer_t>(path, check_names(names)), capacity, policy}
+        {
+        }
+
+    private:
+        static const std::vector<std::string> &check_names(const std::vector<std::string> &names)
+        {
+            if (names.size() > timeseries_row_t::max_columns)
+            {
+                throw std::logic_error("too many columns : " + std::to_string(names.size()) +
+                                       " > " + std::to_string(timeseries_row_t::max_columns));
+            }
+            return names;
+        }
+        async_timeseries_writer_t(std::unique_ptr<timeseries_writer_t> writer_,
+                                  const std::size_t capacity,
+                                  const backpressure_t policy)
+            : columns_amount{writer_->get_columns_amount()},
+              writer{writer_.get()},
+              async_writer{sink_t{std::move(writer_)}, capacity, policy}
+        {
+        }
+
+    public:
+        // одна строка, значения в порядке столбцов; false -- строка выброшена
+        bool add(const double *values, const std::size_t amount)
+        {
+            if (amount != columns_amount)
+            {
+                throw std::logic_error("wrong number of values in a row : " + std::to_string(amount) +
+                                       " != " + std::to_string(columns_amount));
+            }
+            timeseries_row_t row{};
+            std::copy(values, values + amount, row.values.begin());
+            row.size = static_cast<std::uint32_t>(amount);
+            return async_writer.push(row);
+        }
+        bool add(const std::vector<double> &values)
+        {
+            return add(values.data(), values.size());
+        }
+        bool add(std::initializer_list<double> values)
+        {
+            return add(values.begin(), values.size());
+        }
+
+        [[nodiscard]] std::size_t get_dropped_amount() const noexcept
+        {
+            return async_writer.get_dropped_amount();
+        }
+
+        // дописывает очередь и закрывает файл, повторный вызов ничего не делает
+        void close()
+        {
+            async_writer.close();
+            writer->close();
+        }
+    };
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <cassert>
 #include <limits>
 
+#include "../lattices/neighbours_table.hpp"
+
 namespace qss
 {
     template <typename lattice_t,
@@ -23,7 +25,28 @@ namespace qss
             const auto coord = borders_conditions(*it, sizes);
             if (coord)
             {
-                sum += lattice.get(coord.value());
+                sum += lattice.get_unchecked(coord.value());
+            }
+        }
+        return sum;
+    }
+
+    // то же самое, но по номеру узла и заранее построенной таблице соседей
+    template <typename lattice_t, std::size_t neighbours_amount>
+    typename lattice_t::value_t::magn_t get_sum_of_closest_neighbours(
+        const lattice_t &lattice,
+        const typename lattice_t::idx_t central,
+        const qss::lattices::neighbours_table_t<neighbours_amount> &neighbours_table) noexcept
+    {
+        using magn_t = typename lattice_t::value_t::magn_t;
+        using table_t = qss::lattices::neighbours_table_t<neighbours_amount>;
+
+        magn_t sum{};
+        for (const auto neig : neighbours_table[central])
+        {
+            if (neig != table_t::npos)
+            {
+                sum += lattice.get_by_idx(neig);
             }
         }
         return sum;
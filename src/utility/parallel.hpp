@@ -0,0 +1,198 @@
+#ifndef PARALLEL_HPP_INCLUDED
+#define PARALLEL_HPP_INCLUDED
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace qss
+{
+    [[nodiscard]] inline std::size_t get_default_threads_amount() noexcept
+    {
+        const auto amount = std::thread::hardware_concurrency();
+        return amount == 0 ? 1 : static_cast<std::size_t>(amount);
+    }
+
+    /*
+     * запускает func(thread_idx) для thread_idx из [0; threads_amount)
+     * нулевой поток -- вызывающий, возвращается после завершения всех
+     **/
+    template <typename func_t>
+    void parallel_run(const std::size_t threads_amount, func_t &&func)
+    {
+        std::vector<std::thread> threads{};
+        threads.reserve(threads_amount > 0 ? threads_amount - 1 : 0);
+        for (std::size_t thread_idx = 1; thread_idx < threads_amount; ++thread_idx)
+        {
+            threads.emplace_back([&func, thread_idx]() { func(thread_idx); });
+        }
+        func(std::size_t{0});
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    /*
+     * постоянная команда потоков для многократных коротких параллельных проходов:
+     * run(func) выполняет func(thread_idx) для thread_idx из [0; threads_amount) как parallel_run,
+     * но потоки создаются один раз в конструкторе и между вызовами ждут следующего прохода.
+     * нулевой поток -- вызывающий, run возвращается после завершения всех,
+     * первое исключение из func пробрасывается в вызывающий поток.
+     * run нельзя вызывать одновременно из нескольких потоков
+     **/
+    class thread_team
+    {
+        std::vector<std::thread> workers{};
+        std::mutex mutex{};
+        std::condition_variable start_condition{};
+        std::condition_variable finish_condition{};
+        // текущий проход: функция без выделения памяти, по указателю на вызываемый объект
+        void (*invoke)(void *, std::size_t) = nullptr;
+        void *context = nullptr;
+        std::size_t generation = 0;
+        std::size_t remaining = 0;
+        bool stopped = false;
+        std::exception_ptr error{};
+
+        void work(const std::size_t thread_idx)
+        {
+            std::size_t seen = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock lock{mutex};
+                    start_condition.wait(lock, [this, seen]() { return stopped || generation != seen; });
+                    if (stopped)
+                    {
+                        return;
+                    }
+                    seen = generation;
+                }
+                try
+                {
+                    invoke(context, thread_idx);
+                }
+                catch (...)
+                {
+                    std::lock_guard lock{mutex};
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                std::lock_guard lock{mutex};
+                if (--remaining == 0)
+                {
+                    finish_condition.notify_one();
+                }
+            }
+        }
+
+    public:
+        explicit thread_team(const std::size_t threads_amount = get_default_threads_amount())
+        {
+            if (threads_amount == 0)
+            {
+                throw std::logic_error("threads_amount must be positive");
+            }
+            workers.reserve(threads_amount - 1);
+            for (std::size_t thread_idx = 1; thread_idx < threads_amount; ++thread_idx)
+            {
+                workers.emplace_back([this, thread_idx]() { work(thread_idx); });
+            }
+        }
+        thread_team(const thread_team &) = delete;
+        thread_team &operator=(const thread_team &) = delete;
+        ~thread_team()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stopped = true;
+            }
+            start_condition.notify_all();
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        [[nodiscard]] std::size_t get_threads_amount() const noexcept
+        {
+            return workers.size() + 1;
+        }
+
+        template <typename func_t>
+        void run(func_t &&func)
+        {
+            if (workers.empty())
+            {
+                func(std::size_t{0});
+                return;
+            }
+            using callable_t = std::remove_reference_t<func_t>;
+            {
+                std::lock_guard lock{mutex};
+                invoke = [](void *context_, const std::size_t thread_idx)
+                { (*static_cast<callable_t *>(context_))(thread_idx); };
+                context = const_cast<void *>(static_cast<const void *>(std::addressof(func)));
+                remaining = workers.size();
+                error = nullptr;
+                ++generation;
+            }
+            start_condition.notify_all();
+            std::exception_ptr own_error{};
+            try
+            {
+                func(std::size_t{0});
+            }
+            catch (...)
+            {
+                own_error = std::current_exception();
+            }
+            std::unique_lock lock{mutex};
+            finish_condition.wait(lock, [this]() { return remaining == 0; });
+            if (own_error)
+            {
+                std::rethrow_exception(own_error);
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    };
+
+    // полуинтервал [begin; end) доли {thread_idx} из {threads_amount} равных частей
+    [[nodiscard]] inline std::pair<std::size_t, std::size_t> get_chunk(const std::size_t amount,
+                                                                      const std::size_t thread_idx,
+                                                                      const std::size_t threads_amount) noexcept
+    {
+        return {amount * thread_idx / threads_amount, amount * (thread_idx + 1) / threads_amount};
+    }
+
+    /*
+     * то же, но доли состоят из целых блоков по {block_size} элементов.
+     * границы блоков не зависят от числа потоков, поэтому если случайный поток
+     * привязан к блоку, результат не зависит от того, сколько потоков работало
+     **/
+    [[nodiscard]] inline std::pair<std::size_t, std::size_t> get_block_chunk(const std::size_t amount,
+                                                                            const std::size_t block_size,
+                                                                            const std::size_t thread_idx,
+                                                                            const std::size_t threads_amount) noexcept
+    {
+        const auto blocks_amount = (amount + block_size - 1) / block_size;
+        const auto [first_block, last_block] = get_chunk(blocks_amount, thread_idx, threads_amount);
+        return {std::min(amount, first_block * block_size), std::min(amount, last_block * block_size)};
+    }
+}
+
+#endif
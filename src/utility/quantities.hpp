@@ -4,8 +4,12 @@
 #include <type_traits>
 #include <numeric>
 #include <algorithm>
+#include <cstddef>
+#include <vector>
 
 #include "functions.hpp"
+#include "parallel.hpp"
+#include "../lattices/neighbours_table.hpp"
 
 namespace qss
 {
@@ -20,24 +24,36 @@ namespace qss
     }
 
     /*
-    template <typename lattice_t, typename borders_conditions_t>
-    double calculate_energy(const lattice_t &lattice, borders_conditions_t borders_conditions)
+     * полная энергия решётки на узел: H / N = -1/2 sum_i delta_h(h_i, s_i, 0) / N,
+     * где h_i -- сумма соседей узла из таблицы,
+     * а delta_h(h, s_old, s_new) -- та же функция изменения энергии, что передаётся в шаг Метрополиса
+     * (для delta_h = h . (s_old - s_new) это обычное -sum_<ij> s_i . s_j).
+     * узлы делятся между {threads_amount} потоками, частичные суммы складываются в порядке потоков
+     **/
+    template <typename lattice_t, std::size_t neighbours_amount, typename delta_h_t>
+    [[nodiscard]] double calculate_energy(const lattice_t &lattice,
+                                          const qss::lattices::neighbours_table_t<neighbours_amount> &neighbours_table,
+                                          delta_h_t delta_h,
+                                          const std::size_t threads_amount = get_default_threads_amount())
     {
-        using magn_t = typename lattice_t::value_t::magn_t;
-        const auto coords_repr = lattice.as_coords();
-        double energy = 0.0;
-        for (auto elem : coords_repr)
-        {
-            const auto sum = qss::get_sum_of_closest_neighbours(
-                lattice,
-                elem,
-                borders_conditions);
-            energy += sum * static_cast<magn_t>(lattice.get(elem));
-        }
-
-        return 0.5 * energy / static_cast<double>(lattice.get_amount_of_nodes());
+        using value_t = typename lattice_t::value_t;
+        const auto amount = lattice.get_amount_of_nodes();
+        std::vector<double> energies(threads_amount, 0.0);
+        parallel_run(threads_amount, [&](const std::size_t thread_idx)
+                     {
+                         const auto [first, last] = get_chunk(amount, thread_idx, threads_amount);
+                         double energy = 0.0;
+                         for (auto idx = first; idx < last; ++idx)
+                         {
+                             const auto sum = get_sum_of_closest_neighbours(
+                                 lattice,
+                                 static_cast<typename lattice_t::idx_t>(idx),
+                                 neighbours_table);
+                             energy += delta_h(sum, lattice.get_by_idx(idx), value_t::zero());
+                         }
+                         energies[thread_idx] = energy; });
+        return -0.5 * std::accumulate(energies.begin(), energies.end(), 0.0) / static_cast<double>(amount);
     }
-    */
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+#ifndef STATISTICS_HPP_INCLUDED
+#define STATISTICS_HPP_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/*
+ * счётчики горячих циклов (make_step, multilayer_system::evolve, spin_transport::perform)
+ * собираются только при определённом QSS_STATISTICS (cmake -DQSS_STATISTICS=ON),
+ * иначе QSS_STATISTICS_ONLY(...) раскрывается в ничто и циклы не меняются
+ **/
+#if defined(QSS_STATISTICS)
+#define QSS_STATISTICS_ONLY(...) __VA_ARGS__
+#else
+#define QSS_STATISTICS_ONLY(...)
+#endif
+
+namespace qss
+{
+    // причины отказа в шаге
+    enum class rejection_t : std::size_t
+    {
+        boltzmann = 0, // не прошёл тест exp(-dE / T)
+        empty_site,    // spin_transport: в выбранном узле нет электронов, переносить нечего
+    };
+    inline constexpr std::size_t rejections_amount = 2;
+
+    /*
+     * proposals -- попытки, acceptances -- принятые, rejections -- отклонённые по причинам.
+     * время (нс) по фазам шага: neighbours_ns -- расчёт изменения энергии (суммирование соседей),
+     * random_ns -- выбор узла и нового значения, acceptance_ns -- тест принятия и запись
+     **/
+    struct step_statistics_t
+    {
+        static constexpr bool enabled =
+#if defined(QSS_STATISTICS)
+            true;
+#else
+            false;
+#endif
+
+        std::uint64_t proposals = 0;
+        std::uint64_t acceptances = 0;
+        std::array<std::uint64_t, rejections_amount> rejections{};
+        std::uint64_t neighbours_ns = 0;
+        std::uint64_t random_ns = 0;
+        std::uint64_t acceptance_ns = 0;
+
+        [[nodiscard]] std::uint64_t get_rejections(const rejection_t reason) const noexcept
+        {
+            return rejections[static_cast<std::size_t>(reason)];
+        }
+        void reject(const rejection_t reason) noexcept
+        {
+            ++rejections[static_cast<std::size_t>(reason)];
+        }
+        [[nodiscard]] double get_acceptance_rate() const noexcept
+        {
+            return proposals == 0 ? 0.0 : static_cast<double>(acceptances) / static_cast<double>(proposals);
+        }
+
+        step_statistics_t &operator+=(const step_statistics_t &other) noexcept
+        {
+            proposals += other.proposals;
+            acceptances += other.acceptances;
+            for (std::size_t idx = 0; idx < rejections_amount; ++idx)
+            {
+                rejections[idx] += other.rejections[idx];
+            }
+            neighbours_ns += other.neighbours_ns;
+            random_ns += other.random_ns;
+            acceptance_ns += other.acceptance_ns;
+            return *this;
+        }
+        step_statistics_t &operator-=(const step_statistics_t &other) noexcept
+        {
+            proposals -= other.proposals;
+            acceptances -= other.acceptances;
+            for (std::size_t idx = 0; idx < rejections_amount; ++idx)
+            {
+                rejections[idx] -= other.rejections[idx];
+            }
+            neighbours_ns -= other.neighbours_ns;
+            random_ns -= other.random_ns;
+            acceptance_ns -= other.acceptance_ns;
+            return *this;
+        }
+    };
+    inline step_statistics_t operator-(step_statistics_t lhs, const step_statistics_t &rhs) noexcept
+    {
+        return lhs -= rhs;
+    }
+
+    // одной строкой через табуляцию, в порядке полей
+    inline std::ostream &operator<<(std::ostream &out, const step_statistics_t &data) noexcept
+    {
+        out << data.proposals << "\t"
+            << data.acceptances << "\t";
+        for (const auto rejections : data.rejections)
+        {
+            out << rejections << "\t";
+        }
+        out << data.neighbours_ns << "\t"
+            << data.random_ns << "\t"
+            << data.acceptance_ns;
+        return out;
+    }
+
+    /*
+     * накопленная статистика текущего потока, в неё пишут make_step и spin_transport::perform.
+     * читать после шага, сбрасывать take_thread_statistics()
+     **/
+    [[nodiscard]] inline step_statistics_t &get_thread_statistics() noexcept
+    {
+        static thread_local step_statistics_t statistics{};
+        return statistics;
+    }
+    // возвращает накопленное и обнуляет
+    inline step_statistics_t take_thread_statistics() noexcept
+    {
+        auto &statistics = get_thread_statistics();
+        const auto result = statistics;
+        statistics = step_statistics_t{};
+        return result;
+    }
+
+    // lap(target) добавляет в target время с прошлого lap (или создания) в нс
+    class stopwatch_t
+    {
+        using clock_t = std::chrono::steady_clock;
+        clock_t::time_point last = clock_t::now();
+
+    public:
+        void lap(std::uint64_t &target) noexcept
+        {
+            const auto now = clock_t::now();
+            target += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+            last = now;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef SWEEP_HPP_INCLUDED
+#define SWEEP_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace qss
+{
+    // температуры от T_begin до T_end включительно с шагом delta_T
+    [[nodiscard]] inline std::vector<double> get_temperatures(const double T_begin,
+                                                              const double T_end,
+                                                              const double delta_T)
+    {
+        if (!(delta_T > 0.0) || T_end < T_begin)
+        {
+            throw std::logic_error("wrong temperatures range");
+        }
+        std::vector<double> result{};
+        const auto T_amount = static_cast<std::size_t>(std::lround((T_end - T_begin) / delta_T)) + 1;
+        result.reserve(T_amount);
+        for (std::size_t i = 0; i < T_amount; ++i)
+        {
+            result.push_back(T_begin + static_cast<double>(i) * delta_T);
+        }
+        return result;
+    }
+
+    /*
+     * сетка параметров -- декартово произведение списков значений,
+     * например make_grid(temperatures, J_interlayers) -> {T, J} для всех сочетаний.
+     * первый параметр меняется медленнее всех
+     **/
+    template <typename param_t, typename... params_t>
+    [[nodiscard]] std::vector<std::tuple<param_t, params_t...>> make_grid(const std::vector<param_t> &values,
+                                                                           const std::vector<params_t> &...rest)
+    {
+        std::vector<std::tuple<param_t, params_t...>> result{};
+        if constexpr (sizeof...(params_t) == 0)
+        {
+            result.reserve(values.size());
+            for (const auto &value : values)
+            {
+                result.emplace_back(value);
+            }
+        }
+        else
+        {
+            const auto tails = make_grid(rest...);
+            result.reserve(values.size() * tails.size());
+            for (const auto &value : values)
+            {
+                for (const auto &tail : tails)
+                {
+                    result.push_back(std::tuple_cat(std::tuple<param_t>{value}, tail));
+                }
+            }
+        }
+        return result;
+    }
+
+    /*
+     * независимые точки {points} считаются параллельно на пуле {pool}:
+     * для каждой точки в потоке пула создаётся система factory_f(point)
+     * и вызывается run_f(system, point), её результат попадает в ответ на место точки.
+     * исключение из любой точки пробрасывается после завершения остальных.
+     * внутри run_f лучше работать в один поток, параллельность даёт сам перебор точек
+     **/
+    template <typename point_t, typename factory_f_t, typename run_f_t>
+    [[nodiscard]] auto run_sweep(thread_pool &pool,
+                                 const std::vector<point_t> &points,
+                                 factory_f_t factory_f,
+                                 run_f_t run_f)
+    {
+        using system_t = std::invoke_result_t<factory_f_t &, const point_t &>;
+        using result_t = std::invoke_result_t<run_f_t &, system_t &, const point_t &>;
+
+        std::vector<std::future<result_t>> futures{};
+        futures.reserve(points.size());
+        for (const auto &point : points)
+        {
+            futures.push_back(pool.submit([&factory_f, &run_f, &point]()
+                                          {
+                                              auto system = factory_f(point);
+                                              return run_f(system, point); }));
+        }
+        for (auto &future : futures)
+        {
+            future.wait();
+        }
+        std::vector<result_t> results{};
+        results.reserve(points.size());
+        for (auto &future : futures)
+        {
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
+    // то же на собственном пуле из {threads_amount} потоков
+    template <typename point_t, typename factory_f_t, typename run_f_t>
+    [[nodiscard]] auto run_sweep(const std::vector<point_t> &points,
+                                 factory_f_t factory_f,
+                                 run_f_t run_f,
+                                 const std::size_t threads_amount = get_default_threads_amount())
+    {
+        thread_pool pool{threads_amount};
+        return run_sweep(pool, points, std::move(factory_f), std::move(run_f));
+    }
+}
+
+#endif
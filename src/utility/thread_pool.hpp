@@ -0,0 +1,104 @@
+#ifndef THREAD_POOL_HPP_INCLUDED
+#define THREAD_POOL_HPP_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace qss
+{
+    /*
+     * пул из фиксированного числа потоков с общей очередью задач.
+     * submit(func) ставит задачу в очередь и возвращает std::future с её результатом,
+     * исключение из задачи передаётся через тот же future.
+     * деструктор дожидается выполнения всех поставленных задач
+     **/
+    class thread_pool
+    {
+        std::vector<std::thread> workers{};
+        std::queue<std::function<void()>> tasks{};
+        std::mutex mutex{};
+        std::condition_variable condition{};
+        bool stopped = false;
+
+        void work()
+        {
+            while (true)
+            {
+                std::function<void()> task{};
+                {
+                    std::unique_lock lock{mutex};
+                    condition.wait(lock, [this]() { return stopped || !tasks.empty(); });
+                    if (tasks.empty())
+                    {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit thread_pool(const std::size_t threads_amount = get_default_threads_amount())
+        {
+            if (threads_amount == 0)
+            {
+                throw std::logic_error("threads_amount must be positive");
+            }
+            workers.reserve(threads_amount);
+            for (std::size_t i = 0; i < threads_amount; ++i)
+            {
+                workers.emplace_back([this]() { work(); });
+            }
+        }
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+        ~thread_pool()
+        {
+            {
+                std::lock_guard lock{mutex};
+                stopped = true;
+            }
+            condition.notify_all();
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        [[nodiscard]] std::size_t get_threads_amount() const noexcept
+        {
+            return workers.size();
+        }
+
+        template <typename func_t>
+        [[nodiscard]] std::future<std::invoke_result_t<func_t &>> submit(func_t &&func)
+        {
+            using result_t = std::invoke_result_t<func_t &>;
+            // std::function требует копируемости, поэтому packaged_task хранится по указателю
+            auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<func_t>(func));
+            auto result = task->get_future();
+            {
+                std::lock_guard lock{mutex};
+                tasks.emplace([task]() { (*task)(); });
+            }
+            condition.notify_one();
+            return result;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef TIMESERIES_HPP_INCLUDED
+#define TIMESERIES_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace qss
+{
+    /*
+     * двоичный столбцовый формат временных рядов:
+     * заголовок {magic, version, число столбцов, имена столбцов},
+     * затем блоки: число строк блока и значения каждого столбца подряд (double, порядок байт машины).
+     * строки копятся в памяти и пишутся блоками по {block_rows}, то есть одна запись на блок,
+     * а не на строку. в текст переводит qss_timeseries_to_text
+     **/
+    namespace timeseries
+    {
+        inline constexpr char magic[8] = {'Q', 'S', 'S', 'T', 'S', '\0', '\0', '\0'};
+        inline constexpr std::uint32_t version = 1;
+    }
+
+    class timeseries_writer_t
+    {
+        std::ofstream out;
+        std::string path;
+        std::vector<std::vector<double>> columns;
+        std::size_t block_rows;
+        std::size_t rows = 0;
+
+        template <typename value_t>
+        void write(const value_t &value)
+        {
+            write_bytes(&value, sizeof(value_t));
+        }
+        void write_bytes(const void *data, const std::size_t size)
+        {
+            out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+            if (!out)
+            {
+                throw std::runtime_error("cannot write time series : " + path);
+            }
+        }
+
+    public:
+        timeseries_writer_t(const std::string &path_,
+                            const std::vector<std::string> &names,
+                            const std::size_t block_rows_ = 1 << 16)
+            : out{path_, std::ios::binary | std::ios::trunc},
+              path{path_},
+              columns(names.size()),
+              block_rows{block_rows_ == 0 ? 1 : block_rows_}
+        {
+            if (!out)
+            {
+                throw std::runtime_error("cannot open time series for writing : " + path);
+            }
+            if (names.empty())
+            {
+                throw std::logic_error("time series needs at least one column");
+            }
+            write_bytes(timeseries::magic, sizeof(timeseries::magic));
+            write(timeseries::version);
+            write(static_cast<std::uint32_t>(names.size()));
+            for (const auto &name : names)
+            {
+                write(static_cast<std::uint32_t>(name.size()));
+                write_bytes(name.data(), name.size());
+            }
+            for (auto &column : columns)
+            {
+                column.reserve(block_rows);
+            }
+        }
+        timeseries_writer_t(const timeseries_writer_t &) = delete;
+        timeseries_writer_t &operator=(const timeseries_writer_t &) = delete;
+        ~timeseries_writer_t() noexcept
+        {
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        [[nodiscard]] std::size_t get_columns_amount() const noexcept
+        {
+            return columns.size();
+        }
+
+        // одна строка, значения в порядке столбцов
+        void add(const double *values, const std::size_t amount)
+        {
+            if (amount != columns.size())
+            {
+                throw std::logic_error("wrong number of values in a row : " + std::to_string(amount) +
+                                       " != " + std::to_string(columns.size()));
+            }
+            for (std::size_t idx = 0; idx < amount; ++idx)
+            {
+                columns[idx].push_back(values[idx]);
+            }
+            if (++rows == block_rows)
+            {
+                flush();
+            }
+        }
+        void add(const std::vector<double> &values)
+        {
+            add(values.data(), values.size());
+        }
+        void add(std::initializer_list<double> values)
+        {
+            add(values.begin(), values.size());
+        }
+
+        // записывает накопленные строки отдельным блоком
+        void flush()
+        {
+            if (rows == 0)
+            {
+                return;
+            }
+            write(static_cast<std::uint64_t>(rows));
+            for (auto &column : columns)
+            {
+                write_bytes(column.data(), column.size() * sizeof(double));
+                column.clear();
+            }
+            rows = 0;
+            out.flush();
+        }
+        // повторный вызов ничего не делает
+        void close()
+        {
+            if (!out.is_open())
+            {
+                return;
+            }
+            flush();
+            out.close();
+            if (!out)
+            {
+                throw std::runtime_error("cannot write time series : " + path);
+            }
+        }
+    };
+
+    class timeseries_reader_t
+    {
+        std::ifstream in;
+        std::string path;
+        std::vector<std::string> names{};
+
+        template <typename value_t>
+        [[nodiscard]] value_t read()
+        {
+            value_t result{};
+            read_bytes(&result, sizeof(value_t));
+            return result;
+        }
+        void read_bytes(void *data, const std::size_t size)
+        {
+            in.read(static_cast<char *>(data), static_cast<std::streamsize>(size));
+            if (!in)
+            {
+                throw std::runtime_error("time series is truncated : " + path);
+            }
+        }
+
+    public:
+        explicit timeseries_reader_t(const std::string &path_)
+            : in{path_, std::ios::binary},
+              path{path_}
+        {
+            if (!in)
+            {
+                throw std::runtime_error("cannot open time series : " + path);
+            }
+            char magic_[sizeof(timeseries::magic)]{};
+            read_bytes(magic_, sizeof(magic_));
+            if (std::memcmp(magic_, timeseries::magic, sizeof(magic_)) != 0)
+            {
+                throw std::runtime_error("not a time series : " + path);
+            }
+            const auto version_ = read<std::uint32_t>();
+            if (version_ != timeseries::version)
+            {
+                throw std::runtime_error("unsupported time series version : " + std::to_string(version_));
+            }
+            const auto amount = read<std::uint32_t>();
+            names.reserve(amount);
+            for (std::uint32_t idx = 0; idx < amount; ++idx)
+            {
+                std::string name(read<std::uint32_t>(), '\0');
+                read_bytes(name.data(), name.size());
+                names.push_back(std::move(name));
+            }
+        }
+
+        [[nodiscard]] const std::vector<std::string> &get_names() const noexcept
+        {
+            return names;
+        }
+
+        /*
+         * читает очередной блок в columns (по вектору на столбец)
+         * возвращает false, когда блоки закончились
+         **/
+        bool read_block(std::vector<std::vector<double>> &columns)
+        {
+            std::uint64_t rows = 0;
+            in.read(reinterpret_cast<char *>(&rows), sizeof(rows));
+            if (in.gcount() == 0 && in.eof())
+            {
+                return false;
+            }
+            if (!in)
+            {
+                throw std::runtime_error("time series is truncated : " + path);
+            }
+            columns.resize(names.size());
+            for (auto &column : columns)
+            {
+                column.resize(static_cast<std::size_t>(rows));
+                read_bytes(column.data(), column.size() * sizeof(double));
+            }
+            return true;
+        }
+    };
+}
+
+#endif